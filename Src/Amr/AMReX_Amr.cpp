@@ -34,6 +34,7 @@
 #include <AMReX_FabSet.H>
 #include <AMReX_StateData.H>
 #include <AMReX_PlotFileUtil.H>
+#include <AMReX_AsyncOut.H>
 #include <AMReX_Print.H>
 
 #ifdef BL_LAZY
@@ -517,6 +518,10 @@ Amr::InitAmr ()
 
     loadbalance_max_fac = 1.5;
     pp.query("loadbalance_max_fac", loadbalance_max_fac);
+
+    loadbalance_measured_int = 0;
+    pp.query("loadbalance_measured_int", loadbalance_measured_int);
+    loadbalance_measured_step.resize(max_level+1, 0);
 }
 
 int
@@ -908,6 +913,11 @@ Amr::writePlotFile ()
   const std::string pltfileTemp(pltfile + ".temp");
 
   while(sretry.TryFileOutput()) {
+
+    if (AsyncOut::UseAsyncOut()) {
+        AsyncOut::Begin();
+    }
+
     //
     //  if either the pltfile or pltfileTemp exists, rename them
     //  to move them out of the way.  then create pltfile
@@ -980,12 +990,24 @@ Amr::writePlotFile ()
 
 	amrex::Print() << "Write plotfile time = " << dPlotFileTime << "  seconds" << "\n\n";
     }
-    ParallelDescriptor::Barrier("Amr::writePlotFile::end");
+    if (AsyncOut::UseAsyncOut()) {
+        //
+        // The data are still being written.  Rename the directory once
+        // every process has finished.
+        //
+        AsyncOut::End([pltfileTemp, pltfile] () {
+            if(ParallelDescriptor::IOProcessor()) {
+                std::rename(pltfileTemp.c_str(), pltfile.c_str());
+            }
+        });
+    } else {
+        ParallelDescriptor::Barrier("Amr::writePlotFile::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        if(ParallelDescriptor::IOProcessor()) {
+          std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     //
     // the plotfile file now has the regular name
     //
@@ -1795,6 +1817,10 @@ Amr::checkPoint ()
 
   while(sretry.TryFileOutput()) {
 
+    if (AsyncOut::UseAsyncOut()) {
+        AsyncOut::Begin();
+    }
+
     StateData::ClearFabArrayHeaderNames();
 
     //
@@ -1914,12 +1940,24 @@ Amr::checkPoint ()
 
 	amrex::Print() << "checkPoint() time = " << dCheckPointTime << " secs." << '\n';
     }
-    ParallelDescriptor::Barrier("Amr::checkPoint::end");
+    if (AsyncOut::UseAsyncOut()) {
+        //
+        // The data are still being written.  Rename the directory once
+        // every process has finished.
+        //
+        AsyncOut::End([ckfileTemp, ckfile] () {
+            if(ParallelDescriptor::IOProcessor()) {
+                std::rename(ckfileTemp.c_str(), ckfile.c_str());
+            }
+        });
+    } else {
+        ParallelDescriptor::Barrier("Amr::checkPoint::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(ckfileTemp.c_str(), ckfile.c_str());
+        if(ParallelDescriptor::IOProcessor()) {
+          std::rename(ckfileTemp.c_str(), ckfile.c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
 
   }  // end while
 
@@ -2084,6 +2122,28 @@ Amr::timeStep (int  level,
                 level_count[0] = 0;
             }
         }
+        //
+        // Rebalance with the measured cost of the MFIter loops.  Like
+        // regrid, this only touches the levels above this one, which have
+        // not been advanced in this step yet, and level 0.  A remap
+        // rebuilds the AmrLevel, so this level, if it is not level 0, would
+        // lose what the coarser advance has already put into it (e.g., the
+        // coarse contribution to its FluxRegister).
+        //
+        if (loadbalance_measured_int > 0)
+        {
+            for (int lev = (level == 0) ? 0 : level+1; lev <= finest_level; ++lev)
+            {
+                if (!isMeasuringCost(lev)) {
+                    StartCostMeasurement(lev);
+                    loadbalance_measured_step[lev] = level_steps[lev];
+                } else if (level_steps[lev] - loadbalance_measured_step[lev]
+                           >= loadbalance_measured_int) {
+                    LoadBalanceMeasuredCost(lev, time);
+                    loadbalance_measured_step[lev] = level_steps[lev];
+                }
+            }
+        }
     }
     //
     // Check to see if should write plotfile.
@@ -3081,6 +3141,15 @@ Amr::LoadBalanceLevel0 (Real time)
     amr_level[0]->post_regrid(0,time);
 }
 
+void
+Amr::RemapLevel (int lev, Real time, const DistributionMapping& dm)
+{
+    InstallNewDistributionMap(lev, dm);
+    for (int i = 0; i <= finest_level; ++i) {
+        amr_level[i]->post_regrid(std::max(lev-1,0), finest_level);
+    }
+}
+
 void
 Amr::InstallNewDistributionMap (int lev, const DistributionMapping& newdm)
 {
@@ -331,7 +331,7 @@ AmrLevel::writePlotFile (const std::string& dir,
     //
     std::string TheFullPath = FullPath;
     TheFullPath += BaseName;
-    VisMF::Write(plotMF,TheFullPath,how,true);
+    VisMF::WriteMaybeAsync(plotMF,TheFullPath,how,true);
 
     amrex::prefetchToDevice(plotMF);
 
@@ -9,6 +9,7 @@
 #include <AMReX_StateDescriptor.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -802,13 +803,13 @@ StateData::checkPoint (const std::string& name,
     {
        BL_ASSERT(new_data);
        std::string mf_fullpath_new(fullpathname + NewSuffix);
-       VisMF::Write(*new_data,mf_fullpath_new,how);
+       VisMF::WriteMaybeAsync(*new_data,mf_fullpath_new,how);
 
        if (dump_old)
        {
            BL_ASSERT(old_data);
            std::string mf_fullpath_old(fullpathname + OldSuffix);
-           VisMF::Write(*old_data,mf_fullpath_old,how);
+           VisMF::WriteMaybeAsync(*old_data,mf_fullpath_old,how);
        }
     }
 }
@@ -18,6 +18,21 @@ namespace amrex {
 namespace
 {
     bool initialized = false;
+
+    // The average over the maximum of the process loads
+    Real
+    loadEfficiency (const Vector<Real>& cost, const DistributionMapping& dm)
+    {
+        Vector<Real> load(ParallelDescriptor::NProcs(), 0.0);
+        for (int i = 0, N = cost.size(); i < N; ++i) {
+            load[dm[i]] += cost[i];
+        }
+        const Real lmax = *std::max_element(load.begin(), load.end());
+        if (lmax <= 0.0) return 1.0;
+        Real lsum = 0.0;
+        for (Real l : load) lsum += l;
+        return lsum / (load.size()*lmax);
+    }
 }
 
 void
@@ -61,6 +76,9 @@ AmrCore::AmrCore (const RealBox& rb, int max_level_in,
 
 AmrCore::~AmrCore ()
 {
+    for (int lev = 0; lev < m_cost.size(); ++lev) {
+        StopCostMeasurement(lev);
+    }
     Finalize();
 }
 
@@ -71,6 +89,12 @@ AmrCore::InitAmrCore ()
     ParmParse pp("amr");
     pp.query("v",verbose);
 
+    cost_efficiency_threshold = 0.9;
+    pp.query("cost_efficiency_threshold", cost_efficiency_threshold);
+
+    cost_min_gain = 0.05;
+    pp.query("cost_min_gain", cost_min_gain);
+
 #ifdef AMREX_PARTICLES
     m_gdb.reset(new AmrParGDB(this));
 #endif
@@ -121,6 +145,98 @@ AmrCore::regrid (int lbase, Real time, bool)
     finest_level = new_finest;
 }
 
+void
+AmrCore::RemapLevel (int lev, Real time, const DistributionMapping& dm)
+{
+    RemakeLevel(lev, time, grids[lev], dm);
+    SetDistributionMap(lev, dm);
+}
+
+void
+AmrCore::StartCostMeasurement (int lev)
+{
+    StopCostMeasurement(lev);
+    if (lev >= m_cost.size()) {
+        m_cost.resize(lev+1);
+        m_cost_predicted.resize(lev+1, -1.0);
+    }
+    m_cost[lev].reset(new LayoutData<Real>(grids[lev], dmap[lev]));
+    MFIter::RegisterCost(m_cost[lev].get());
+}
+
+void
+AmrCore::StopCostMeasurement (int lev)
+{
+    if (lev < m_cost.size() && m_cost[lev]) {
+        MFIter::DeregisterCost(m_cost[lev].get());
+        m_cost[lev].reset();
+    }
+}
+
+bool
+AmrCore::isMeasuringCost (int lev) const noexcept
+{
+    return lev < m_cost.size() && m_cost[lev]
+        && m_cost[lev]->boxArray() == grids[lev]
+        && m_cost[lev]->DistributionMap() == dmap[lev];
+}
+
+const LayoutData<Real>*
+AmrCore::MeasuredCost (int lev) const noexcept
+{
+    return isMeasuringCost(lev) ? m_cost[lev].get() : nullptr;
+}
+
+bool
+AmrCore::LoadBalanceMeasuredCost (int lev, Real time)
+{
+    BL_PROFILE("AmrCore::LoadBalanceMeasuredCost()");
+
+    if (!isMeasuringCost(lev)) {
+        StartCostMeasurement(lev);
+        return false;
+    }
+
+    const LayoutData<Real>& cost = *m_cost[lev];
+    Vector<Real> rcost(grids[lev].size(), 0.0);
+    for (int i : cost.IndexArray()) {
+        rcost[i] = cost[i];
+    }
+    ParallelDescriptor::ReduceRealSum(rcost.data(), rcost.size());
+
+    const Real eff = loadEfficiency(rcost, dmap[lev]);
+    bool remap = false;
+    Real neweff = eff;
+    DistributionMapping newdm;
+    if (eff < cost_efficiency_threshold) {
+        newdm = DistributionMapping::makeKnapSack(rcost);
+        neweff = loadEfficiency(rcost, newdm);
+        remap = neweff > eff*(1.0+cost_min_gain);
+    }
+
+    if (verbose > 0) {
+        amrex::Print() << "Level " << lev << " measured cost efficiency: " << eff;
+        if (m_cost_predicted[lev] >= 0.0) {
+            amrex::Print() << " (predicted " << m_cost_predicted[lev] << ")";
+        }
+        if (eff < cost_efficiency_threshold) {
+            amrex::Print() << ", knapsack " << neweff << (remap ? ", remapping" : "");
+        }
+        amrex::Print() << "\n";
+    }
+
+    if (remap) {
+        RemapLevel(lev, time, newdm);
+        m_cost_predicted[lev] = neweff;
+    } else {
+        m_cost_predicted[lev] = -1.0;
+    }
+
+    StartCostMeasurement(lev);
+
+    return remap;
+}
+
 
 void
 AmrCore::printGridSummary (std::ostream& os, int min_lev, int max_lev) const noexcept
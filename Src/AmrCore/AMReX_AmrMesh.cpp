@@ -76,6 +76,7 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 
     use_new_chop         = false;
     iterate_on_new_grids = true;
+    use_distributed_clustering = false;
 
     ParmParse pp("amr");
 
@@ -113,6 +114,7 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 
     pp.query("n_proper",n_proper);
     pp.query("grid_eff",grid_eff);
+    pp.query("distributed_clustering",use_distributed_clustering);
     int cnt = pp.countval("n_error_buf");
     if (cnt > 0) {
         Vector<int> neb;
@@ -696,40 +698,100 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
         //
         tags.setVal(p_n_comp[levc],TagBox::CLEAR);
         //
-        // Create initial cluster containing all tagged points.
+        // Cluster the tagged points into efficient boxes.
         //
-	Vector<IntVect> tagvec;
-	tags.collate(tagvec);
-        tags.clear();
+        bool any_tags = false;
+        BoxList new_bx;
 
-        if (tagvec.size() > 0)
+        if (use_distributed_clustering)
         {
             //
-            // Created new level, now generate efficient grids.
+            // Each process clusters its own tags.  Only the resulting
+            // boxes are communicated; the global tag list is never built.
             //
-            if ( !(useFixedCoarseGrids() && levc<useFixedUpToLevel()) ) {
-                new_finest = std::max(new_finest,levf);
-	    }
+            BL_PROFILE("AmrMesh::MakeNewGrids::ClusterDistributed");
+
+            Vector<IntVect> tagvec;
+            tags.local_collate(tagvec);
+            tags.clear();
+
+            BoxList local_bx;
+            if (tagvec.size() > 0)
+            {
+                ClusterList clist(&tagvec[0], tagvec.size());
+                if (use_new_chop)
+                {
+                    clist.new_chop(grid_eff);
+                } else {
+                    clist.chop(grid_eff);
+                }
+                BoxDomain bd;
+                bd.add(p_n[levc]);
+                clist.intersect(bd);
+                bd.clear();
+                clist.boxList(local_bx);
+            }
+
+            Vector<Box> bxs(local_bx.begin(), local_bx.end());
+            local_bx.clear();
+            amrex::AllGatherBoxes(bxs);
+
+            if (bxs.size() > 0)
+            {
+                any_tags = true;
+                //
+                // Clusters from different processes may overlap because
+                // the TagBoxes include ghost cells.
+                //
+                BoxArray ba(BoxList(std::move(bxs)));
+                ba.removeOverlap();
+                new_bx = ba.boxList();
+            }
+        }
+        else
+        {
+            BL_PROFILE("AmrMesh::MakeNewGrids::Cluster");
             //
-            // Construct initial cluster.
+            // Create initial cluster containing all tagged points.
             //
-            ClusterList clist(&tagvec[0], tagvec.size());
-            if (use_new_chop)
+            Vector<IntVect> tagvec;
+            tags.collate(tagvec);
+            tags.clear();
+
+            if (tagvec.size() > 0)
             {
-               clist.new_chop(grid_eff);
-            } else {
-               clist.chop(grid_eff);
+                any_tags = true;
+                //
+                // Construct initial cluster.
+                //
+                ClusterList clist(&tagvec[0], tagvec.size());
+                if (use_new_chop)
+                {
+                    clist.new_chop(grid_eff);
+                } else {
+                    clist.chop(grid_eff);
+                }
+                BoxDomain bd;
+                bd.add(p_n[levc]);
+                clist.intersect(bd);
+                bd.clear();
+                //
+                // Efficient properly nested Clusters have been constructed
+                // now generate list of grids at level levf.
+                //
+                clist.boxList(new_bx);
             }
-            BoxDomain bd;
-            bd.add(p_n[levc]);
-            clist.intersect(bd);
-            bd.clear();
+        }
+
+        if (any_tags)
+        {
             //
-            // Efficient properly nested Clusters have been constructed
-            // now generate list of grids at level levf.
+            // Created new level, now generate efficient grids.
             //
-            BoxList new_bx;
-            clist.boxList(new_bx);
+            if ( !(useFixedCoarseGrids() && levc<useFixedUpToLevel()) ) {
+                new_finest = std::max(new_finest,levf);
+	    }
+
             new_bx.refine(bf_lev[levc]);
             new_bx.simplify();
             BL_ASSERT(new_bx.isDisjoint());
@@ -52,9 +52,17 @@ namespace amrex
 	BL_ASSERT(smf.size() == stime.size());
 	BL_ASSERT(smf.size() != 0);
 
-	if (smf.size() == 1)
+	// At one of the source times there is nothing to interpolate.
+	const MultiFab* single = nullptr;
+	if (smf.size() == 1 || (smf.size() == 2 && time == stime[0])) {
+	    single = smf[0];
+	} else if (smf.size() == 2 && time == stime[1]) {
+	    single = smf[1];
+	}
+
+	if (single)
 	{
-	    mf.ParallelCopy(*smf[0], scomp, dcomp, ncomp, IntVect{0}, mf.nGrowVect(), geom.periodicity());
+	    mf.ParallelCopy(*single, scomp, dcomp, ncomp, IntVect{0}, mf.nGrowVect(), geom.periodicity());
 	}
 	else if (smf.size() == 2)
 	{
@@ -128,7 +136,121 @@ namespace amrex
 	physbcf.FillBoundary(mf, dcomp, ncomp, time, bcfcomp);
     }
 
-    namespace { void FillPatchTwoLevels_doit
+    namespace {
+
+    //
+    // Fills the coarse patch, whose cells are all inside the coarse level
+    // or outside the domain.  If the patch is smaller than the coarse
+    // level, the time interpolation is done on the patch after copying the
+    // two coarse states into it, rather than on the whole coarse level.
+    //
+    void FillCrsePatch (MultiFab& mf_crse_patch, Real time,
+                        const Vector<MultiFab*>& cmf, const Vector<Real>& ct,
+                        int scomp, int ncomp,
+                        const Geometry& cgeom, PhysBCFunctBase& cbc, int cbccomp)
+    {
+        BL_PROFILE("FillPatchTwoLevels::crse_patch");
+
+        mf_crse_patch.setDomainBndry(std::numeric_limits<Real>::quiet_NaN(), cgeom);
+
+        if (cmf.size() == 2 && time != ct[0] && time != ct[1] &&
+            std::abs(ct[1]-ct[0]) > 1.e-16 &&
+            mf_crse_patch.boxArray().numPts() < cmf[0]->boxArray().numPts())
+        {
+            MultiFab tmp(mf_crse_patch.boxArray(), mf_crse_patch.DistributionMap(), ncomp, 0,
+                         MFInfo(), mf_crse_patch.Factory());
+            tmp.setDomainBndry(std::numeric_limits<Real>::quiet_NaN(), cgeom);
+            mf_crse_patch.ParallelCopy(*cmf[0], scomp, 0, ncomp, cgeom.periodicity());
+            tmp.ParallelCopy(*cmf[1], scomp, 0, ncomp, cgeom.periodicity());
+
+            const Real alpha = (ct[1]-time)/(ct[1]-ct[0]);
+            const Real beta = (time-ct[0])/(ct[1]-ct[0]);
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(mf_crse_patch,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.tilebox();
+                auto       dfab = mf_crse_patch.array(mfi);
+                auto const tfab = tmp.array(mfi);
+                AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+                {
+                    dfab(i,j,k,n) = alpha*dfab(i,j,k,n) + beta*tfab(i,j,k,n);
+                });
+            }
+
+            cbc.FillBoundary(mf_crse_patch, 0, ncomp, time, cbccomp);
+        }
+        else
+        {
+            FillPatchSingleLevel(mf_crse_patch, time, cmf, ct, scomp, 0, ncomp, cgeom, cbc, cbccomp);
+        }
+    }
+
+    //
+    // Interpolates from the coarse patch to the parts of mf that are not
+    // covered by fine data.  pre_interp may modify the coarse patch.
+    //
+    void InterpFromCrsePatch (MultiFab& mf, MultiFab& mf_crse_patch,
+                              const FabArrayBase::FPinfo& fpc, const Box& fdomain,
+                              int dcomp, int ncomp,
+                              const Geometry& cgeom, const Geometry& fgeom,
+                              const IntVect& ratio, Interpolater* mapper,
+                              const Vector<BCRec>& bcs, int bcscomp,
+                              const InterpHook& pre_interp,
+                              const InterpHook& post_interp)
+    {
+        BL_PROFILE("FillPatchTwoLevels::interp");
+
+        int idummy1=0, idummy2=0;
+        bool cc = fpc.ba_crse_patch.ixType().cellCentered();
+        ignore_unused(cc);
+#ifdef _OPENMP
+#pragma omp parallel if (cc && Gpu::notInLaunchRegion())
+#endif
+        {
+            Vector<BCRec> bcr(ncomp);
+            for (MFIter mfi(mf_crse_patch); mfi.isValid(); ++mfi)
+            {
+                FArrayBox& sfab = mf_crse_patch[mfi];
+                int li = mfi.LocalIndex();
+                int gi = fpc.dst_idxs[li];
+                FArrayBox& dfab = mf[gi];
+                const Box& dbx = fpc.dst_boxes[li] & dfab.box();
+
+                amrex::setBC(dbx,fdomain,bcscomp,0,ncomp,bcs,bcr);
+
+                pre_interp(sfab, sfab.box(), 0, ncomp);
+
+                mapper->interp(sfab,
+                               0,
+                               dfab,
+                               dcomp,
+                               ncomp,
+                               dbx,
+                               ratio,
+                               cgeom,
+                               fgeom,
+                               bcr,
+                               idummy1, idummy2, RunOn::Gpu);
+
+                post_interp(dfab, dbx, dcomp, ncomp);
+            }
+        }
+    }
+
+    Box periodicGrownDomain (const Geometry& fgeom, const IndexType& typ, const IntVect& ngrow)
+    {
+        Box fdomain_g = amrex::convert(fgeom.Domain(), typ);
+        for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+            if (fgeom.isPeriodic(i)) {
+                fdomain_g.grow(i,ngrow[i]);
+            }
+        }
+        return fdomain_g;
+    }
+
+    void FillPatchTwoLevels_doit
                             (MultiFab& mf, Real time,
 			     const Vector<MultiFab*>& cmf, const Vector<Real>& ct,
 			     const Vector<MultiFab*>& fmf, const Vector<Real>& ft,
@@ -151,14 +273,8 @@ namespace amrex
 	{
 	    const InterpolaterBoxCoarsener& coarsener = mapper->BoxCoarsener(ratio);
 
-	    Box fdomain = fgeom.Domain();
-	    fdomain.convert(mf.boxArray().ixType());
-	    Box fdomain_g(fdomain);
-	    for (int i = 0; i < AMREX_SPACEDIM; ++i) {
-		if (fgeom.isPeriodic(i)) {
-		    fdomain_g.grow(i,ngrow[i]);
-		}
-	    }
+	    const Box& fdomain = amrex::convert(fgeom.Domain(), mf.boxArray().ixType());
+	    const Box& fdomain_g = periodicGrownDomain(fgeom, mf.boxArray().ixType(), ngrow);
 
 	    const FabArrayBase::FPinfo& fpc = FabArrayBase::TheFPinfo(*fmf[0], mf, fdomain_g,
                                                                       ngrow,
@@ -171,50 +287,17 @@ namespace amrex
 		MultiFab mf_crse_patch(fpc.ba_crse_patch, fpc.dm_crse_patch, ncomp, 0, MFInfo(),
                                        *fpc.fact_crse_patch);
 
-                mf_crse_patch.setDomainBndry(std::numeric_limits<Real>::quiet_NaN(), cgeom);
+		FillCrsePatch(mf_crse_patch, time, cmf, ct, scomp, ncomp, cgeom, cbc, cbccomp);
 
-		FillPatchSingleLevel(mf_crse_patch, time, cmf, ct, scomp, 0, ncomp, cgeom, cbc, cbccomp);
-
-		int idummy1=0, idummy2=0;
-		bool cc = fpc.ba_crse_patch.ixType().cellCentered();
-                ignore_unused(cc);
-#ifdef _OPENMP
-#pragma omp parallel if (cc && Gpu::notInLaunchRegion())
-#endif
-                {
-                    Vector<BCRec> bcr(ncomp);
-                    for (MFIter mfi(mf_crse_patch); mfi.isValid(); ++mfi)
-                    {
-                        FArrayBox& sfab = mf_crse_patch[mfi];
-                        int li = mfi.LocalIndex();
-                        int gi = fpc.dst_idxs[li];
-                        FArrayBox& dfab = mf[gi];
-                        const Box& dbx = fpc.dst_boxes[li] & dfab.box();
-
-                        amrex::setBC(dbx,fdomain,bcscomp,0,ncomp,bcs,bcr);
-
-                        pre_interp(sfab, sfab.box(), 0, ncomp);
-
-                        mapper->interp(sfab,
-                                       0,
-                                       dfab,
-                                       dcomp,
-                                       ncomp,
-                                       dbx,
-                                       ratio,
-                                       cgeom,
-                                       fgeom,
-                                       bcr,
-                                       idummy1, idummy2, RunOn::Gpu);
-
-                        post_interp(dfab, dbx, dcomp, ncomp);
-                    }
-                }
+		InterpFromCrsePatch(mf, mf_crse_patch, fpc, fdomain, dcomp, ncomp, cgeom, fgeom,
+                                    ratio, mapper, bcs, bcscomp, pre_interp, post_interp);
 	    }
 	}
 
 	FillPatchSingleLevel(mf, time, fmf, ft, scomp, dcomp, ncomp, fgeom, fbc, fbccomp);
-    } }
+    }
+
+    }
 
     void FillPatchTwoLevels (MultiFab& mf, Real time,
                              const Vector<MultiFab*>& cmf, const Vector<Real>& ct,
@@ -261,6 +344,121 @@ namespace amrex
     }
 #endif
 
+    void FillPatchCrseCache::clear ()
+    {
+        m_patch.reset();
+        m_cmf.clear();
+        m_ct.clear();
+    }
+
+    MultiFab* FillPatchCrseCache::find (const BoxArray& ba, const DistributionMapping& dm,
+                                        const Vector<MultiFab*>& cmf, const Vector<Real>& ct,
+                                        Real time, int scomp, int ncomp)
+    {
+        if (m_patch && m_cmf == cmf && m_ct == ct && m_time == time &&
+            m_scomp == scomp && m_ncomp == ncomp &&
+            m_patch->boxArray() == ba && m_patch->DistributionMap() == dm)
+        {
+            ++m_nhits;
+            return m_patch.get();
+        }
+        return nullptr;
+    }
+
+    void FillPatchCrseCache::store (std::unique_ptr<MultiFab>&& patch,
+                                    const Vector<MultiFab*>& cmf, const Vector<Real>& ct,
+                                    Real time, int scomp, int ncomp)
+    {
+        m_patch = std::move(patch);
+        m_cmf = cmf;
+        m_ct = ct;
+        m_time = time;
+        m_scomp = scomp;
+        m_ncomp = ncomp;
+    }
+
+    void FillPatchGhostTwoLevels (MultiFab& mf, Real time,
+                                  const Vector<MultiFab*>& cmf, const Vector<Real>& ct,
+                                  int scomp, int dcomp, int ncomp,
+                                  const Geometry& cgeom, const Geometry& fgeom,
+                                  PhysBCFunctBase& cbc, int cbccomp,
+                                  PhysBCFunctBase& fbc, int fbccomp,
+                                  const IntVect& ratio,
+                                  Interpolater* mapper,
+                                  const Vector<BCRec>& bcs, int bcscomp,
+                                  FillPatchCrseCache* cache,
+                                  const InterpHook& pre_interp,
+                                  const InterpHook& post_interp)
+    {
+        BL_PROFILE("FillPatchGhostTwoLevels");
+
+        const IntVect& ngrow = mf.nGrowVect();
+
+        if (ngrow.max() > 0)
+        {
+#ifdef AMREX_USE_EB
+            EB2::IndexSpace const* index_space = EB2::TopIndexSpaceIfPresent();
+#else
+            EB2::IndexSpace const* index_space = nullptr;
+#endif
+            const InterpolaterBoxCoarsener& coarsener = mapper->BoxCoarsener(ratio);
+
+            const Box& fdomain = amrex::convert(fgeom.Domain(), mf.boxArray().ixType());
+            const Box& fdomain_g = periodicGrownDomain(fgeom, mf.boxArray().ixType(), ngrow);
+
+            // With mf as its own source, the boxes to interpolate are the
+            // ghost cells not covered by the fine grids.
+            const FabArrayBase::FPinfo& fpc = FabArrayBase::TheFPinfo(mf, mf, fdomain_g,
+                                                                      ngrow,
+                                                                      coarsener,
+                                                                      amrex::coarsen(fgeom.Domain(),ratio),
+                                                                      index_space);
+
+            if ( ! fpc.ba_crse_patch.empty())
+            {
+                MultiFab* patch = nullptr;
+                if (cache) {
+                    patch = cache->find(fpc.ba_crse_patch, fpc.dm_crse_patch,
+                                        cmf, ct, time, scomp, ncomp);
+                }
+
+                std::unique_ptr<MultiFab> new_patch;
+                if (patch == nullptr)
+                {
+                    new_patch.reset(new MultiFab(fpc.ba_crse_patch, fpc.dm_crse_patch, ncomp, 0,
+                                                 MFInfo(), *fpc.fact_crse_patch));
+                    FillCrsePatch(*new_patch, time, cmf, ct, scomp, ncomp, cgeom, cbc, cbccomp);
+                    patch = new_patch.get();
+                }
+
+                // pre_interp may modify the patch, so the cached one is not
+                // given to it.
+                const bool keep = cache && new_patch;
+                const bool modified = dynamic_cast<const NullInterpHook*>(&pre_interp) == nullptr;
+                MultiFab patch_copy;
+                if (modified && (keep || new_patch == nullptr)) {
+                    patch_copy.define(patch->boxArray(), patch->DistributionMap(), ncomp, 0,
+                                      MFInfo(), patch->Factory());
+                    MultiFab::Copy(patch_copy, *patch, 0, 0, ncomp, 0);
+                    patch = &patch_copy;
+                }
+
+                InterpFromCrsePatch(mf, *patch, fpc, fdomain, dcomp, ncomp, cgeom, fgeom,
+                                    ratio, mapper, bcs, bcscomp, pre_interp, post_interp);
+
+                if (keep) {
+                    cache->store(std::move(new_patch), cmf, ct, time, scomp, ncomp);
+                }
+            }
+
+            BL_PROFILE_VAR("FillPatchGhostTwoLevels::fine", blp_fine);
+            mf.FillBoundary(dcomp, ncomp, fgeom.periodicity());
+            BL_PROFILE_VAR_STOP(blp_fine);
+        }
+
+        fbc.FillBoundary(mf, dcomp, ncomp, time, fbccomp);
+    }
+
     void InterpFromCoarseLevel (MultiFab& mf, Real time, const MultiFab& cmf,
                                 int scomp, int dcomp, int ncomp,
                                 const Geometry& cgeom, const Geometry& fgeom,
@@ -4,6 +4,8 @@
 #include <AMReX_CArena.H>
 #include <AMReX_DArena.H>
 #include <AMReX_EArena.H>
+#include <AMReX_NArena.H>
+#include <AMReX_SArena.H>
 
 #include <AMReX.H>
 #include <AMReX_Print.H>
@@ -27,6 +29,7 @@ namespace {
     bool use_buddy_allocator = false;
     long buddy_allocator_size = 0L;
     long the_arena_init_size = 0L;
+    std::string the_arena_type;
     bool abort_on_out_of_gpu_memory = false;
 }
 
@@ -131,6 +134,7 @@ Arena::Initialize ()
     pp.query("use_buddy_allocator", use_buddy_allocator);
     pp.query("buddy_allocator_size", buddy_allocator_size);
     pp.query("the_arena_init_size", the_arena_init_size);
+    pp.query("the_arena_type", the_arena_type);
     pp.query("abort_on_out_of_gpu_memory", abort_on_out_of_gpu_memory);
 
 #ifdef AMREX_USE_GPU
@@ -145,6 +149,29 @@ Arena::Initialize ()
     }
     else
 #endif
+    if (!the_arena_type.empty())
+    {
+        if (the_arena_type == "CArena") {
+            the_arena = new CArena(0, ArenaInfo().SetPreferred());
+        } else if (the_arena_type == "BArena") {
+            the_arena = new BArena;
+        } else if (the_arena_type == "SArena") {
+#ifdef AMREX_USE_GPU
+            amrex::Abort("amrex.the_arena_type = SArena is not supported with GPU");
+#else
+            the_arena = new SArena;
+#endif
+        } else if (the_arena_type == "NArena") {
+#ifdef AMREX_USE_GPU
+            amrex::Abort("amrex.the_arena_type = NArena is not supported with GPU");
+#else
+            the_arena = new NArena;
+#endif
+        } else {
+            amrex::Abort("Unknown amrex.the_arena_type: " + the_arena_type);
+        }
+    }
+    else
     {
 #if defined(BL_COALESCE_FABS) || defined(AMREX_USE_GPU)
         the_arena = new CArena(0, ArenaInfo().SetPreferred());
@@ -221,9 +248,20 @@ Arena::PrintUsage ()
     }
 #endif
     if (The_Arena()) {
-        CArena* p = dynamic_cast<CArena*>(The_Arena());
-        if (p) {
-            long min_megabytes = p->heap_space_used() / (1024*1024);
+        std::size_t heap_space_used = 0;
+        bool has_usage = false;
+        if (CArena* p = dynamic_cast<CArena*>(The_Arena())) {
+            heap_space_used = p->heap_space_used();
+            has_usage = true;
+        } else if (SArena* p = dynamic_cast<SArena*>(The_Arena())) {
+            heap_space_used = p->heap_space_used();
+            has_usage = true;
+        } else if (NArena* p = dynamic_cast<NArena*>(The_Arena())) {
+            heap_space_used = p->heap_space_used();
+            has_usage = true;
+        }
+        if (has_usage) {
+            long min_megabytes = heap_space_used / (1024*1024);
             long max_megabytes = min_megabytes;
             ParallelDescriptor::ReduceLongMin(min_megabytes, IOProc);
             ParallelDescriptor::ReduceLongMax(max_megabytes, IOProc);
@@ -0,0 +1,187 @@
+#include <deque>
+#include <fstream>
+
+#include <AMReX_AsyncOut.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+#include <AMReX_Print.H>
+#include <AMReX.H>
+
+namespace amrex {
+namespace AsyncOut {
+
+namespace {
+
+    bool s_initialized = false;
+    bool s_use_async_out = false;
+    int  s_max_inflight = 2;
+
+    struct Output
+    {
+        Vector<std::future<WriteAsyncStatus> > futures;
+        std::function<void()> finish;
+    };
+
+    std::deque<Output> s_outputs;
+    Output s_current;
+    bool s_open = false;
+
+    void complete_oldest ()
+    {
+        BL_PROFILE("AsyncOut::complete");
+
+        Output& output = s_outputs.front();
+
+        long nbytes = 0;
+        Real t_write = 0.0;
+        for (auto& f : output.futures) {
+            WriteAsyncStatus status = f.get();
+            nbytes += status.nbytes;
+            t_write = std::max(t_write, status.t_total);
+        }
+
+        // Every process must be done before the output is usable.
+        ParallelDescriptor::Barrier("AsyncOut::complete");
+
+        if (output.finish) {
+            output.finish();
+        }
+
+        if (amrex::Verbose() > 1) {
+            ParallelDescriptor::ReduceLongSum(nbytes, ParallelDescriptor::IOProcessorNumber());
+            ParallelDescriptor::ReduceRealMax(t_write, ParallelDescriptor::IOProcessorNumber());
+            amrex::Print() << "AsyncOut: completed output of " << nbytes << " bytes, "
+                           << "max background write time = " << t_write << " seconds\n";
+        }
+
+        s_outputs.pop_front();
+    }
+}
+
+void
+Initialize ()
+{
+    if (s_initialized) return;
+    s_initialized = true;
+
+    ParmParse pp("amrex");
+    pp.query("async_out", s_use_async_out);
+    pp.query("async_out_max_inflight", s_max_inflight);
+    s_max_inflight = std::max(s_max_inflight, 1);
+
+#ifdef AMREX_USE_GPU
+    // VisMF::WriteAsync does not compute FAB min/max on the device yet.
+    s_use_async_out = false;
+#endif
+
+    amrex::ExecOnFinalize(AsyncOut::Finalize);
+}
+
+void
+Finalize ()
+{
+    if (!s_initialized) return;
+    Finish();
+    s_initialized = false;
+}
+
+bool
+UseAsyncOut ()
+{
+    return s_use_async_out;
+}
+
+int
+MaxInFlight ()
+{
+    return s_max_inflight;
+}
+
+int
+NumInFlight ()
+{
+    return s_outputs.size() + (s_open ? 1 : 0);
+}
+
+void
+Begin ()
+{
+    if (s_open) {
+        amrex::Abort("AsyncOut::Begin: previous output not ended");
+    }
+
+    while (static_cast<int>(s_outputs.size()) >= s_max_inflight) {
+        complete_oldest();
+    }
+
+    s_open = true;
+}
+
+void
+Add (std::future<WriteAsyncStatus>&& f)
+{
+    if (s_open) {
+        s_current.futures.push_back(std::move(f));
+    } else {
+        f.wait();
+    }
+}
+
+void
+End (std::function<void()> const& finish)
+{
+    if (!s_open) {
+        amrex::Abort("AsyncOut::End: no output to end");
+    }
+
+    s_current.finish = finish;
+    s_outputs.push_back(std::move(s_current));
+    s_current = Output();
+    s_open = false;
+}
+
+void
+Finish ()
+{
+    BL_PROFILE("AsyncOut::Finish()");
+
+    if (s_open) {
+        End();
+    }
+
+    while (!s_outputs.empty()) {
+        complete_oldest();
+    }
+}
+
+std::future<WriteAsyncStatus>
+WriteFileAsync (const std::string& file_name, std::string&& content)
+{
+    return std::async(std::launch::async,
+    [file_name] (std::string const& s) -> WriteAsyncStatus
+    {
+        Real tbegin = amrex::second();
+
+        std::ofstream ofs(file_name.c_str(), std::ios::out | std::ios::trunc |
+                                             std::ios::binary);
+        if (!ofs.good()) amrex::FileOpenFailed(file_name);
+        ofs.write(s.data(), s.size());
+        ofs.close();
+
+        Real t_write = amrex::second() - tbegin;
+
+        WriteAsyncStatus status;
+        status.nbytes = s.size();
+        status.nspins = 0;
+        status.t_total = t_write;
+        status.t_header = 0.0;
+        status.t_spin = 0.0;
+        status.t_write = t_write;
+        status.t_send = 0.0;
+        return status;
+    },
+    std::move(content));
+}
+
+}}
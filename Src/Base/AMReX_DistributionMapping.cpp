@@ -38,6 +38,58 @@ namespace amrex {
     int    sfc_threshold;
     Real   max_efficiency;
     int    node_size;
+    int    comm_ngrow;
+    Real   comm_tolerance;
+
+namespace {
+    Vector<int> node_of_rank;
+
+    //
+    // Find the node of every rank in ParallelDescriptor::Communicator().
+    // Nodes are numbered in the order of their lowest rank.
+    //
+    void build_node_of_rank ()
+    {
+        const int nprocs = ParallelDescriptor::NProcs();
+        node_of_rank.resize(nprocs);
+
+        if (node_size > 0)
+        {
+            for (int i = 0; i < nprocs; ++i) {
+                node_of_rank[i] = i / node_size;
+            }
+            return;
+        }
+
+#ifdef BL_USE_MPI
+        const int myproc = ParallelDescriptor::MyProc();
+        MPI_Comm local_comm;
+        MPI_Comm_split_type(ParallelDescriptor::Communicator(), MPI_COMM_TYPE_SHARED,
+                            myproc, MPI_INFO_NULL, &local_comm);
+        // The key orders the ranks, so rank 0 of local_comm is the lowest rank on the node.
+        int leader = myproc;
+        MPI_Bcast(&leader, 1, MPI_INT, 0, local_comm);
+        MPI_Comm_free(&local_comm);
+
+        Vector<int> leaders(nprocs);
+        ParallelAllGather::AllGather(leader, leaders.dataPtr(), ParallelDescriptor::Communicator());
+
+        std::map<int,int> node_id;
+        for (int l : leaders) {
+            node_id.insert(std::make_pair(l,0));
+        }
+        int inode = 0;
+        for (auto& kv : node_id) {
+            kv.second = inode++;
+        }
+        for (int i = 0; i < nprocs; ++i) {
+            node_of_rank[i] = node_id[leaders[i]];
+        }
+#else
+        node_of_rank[0] = 0;
+#endif
+    }
+}
 
 // We default to SFC.
 DistributionMapping::Strategy DistributionMapping::m_Strategy = DistributionMapping::SFC;
@@ -75,6 +127,9 @@ DistributionMapping::strategy (DistributionMapping::Strategy how)
     case RRSFC:
         m_BuildMap = &DistributionMapping::RRSFCProcessorMap;
         break;
+    case COMMSFC:
+        m_BuildMap = &DistributionMapping::CommSFCProcessorMap;
+        break;
     default:
         amrex::Error("Bad DistributionMapping::Strategy");
     }
@@ -115,6 +170,8 @@ DistributionMapping::Initialize ()
     sfc_threshold    = 0;
     max_efficiency   = 0.9;
     node_size        = 0;
+    comm_ngrow       = 1;
+    comm_tolerance   = 0.1;
     flag_verbose_mapper = 0;
 
     ParmParse pp("DistributionMapping");
@@ -124,6 +181,8 @@ DistributionMapping::Initialize ()
     pp.query("efficiency",          max_efficiency);
     pp.query("sfc_threshold",       sfc_threshold);
     pp.query("node_size",           node_size);
+    pp.query("comm_ngrow",          comm_ngrow);
+    pp.query("comm_tolerance",      comm_tolerance);
     pp.query("verbose_mapper",      flag_verbose_mapper);
 
     std::string theStrategy;
@@ -146,6 +205,10 @@ DistributionMapping::Initialize ()
         {
             strategy(RRSFC);
         }
+        else if (theStrategy == "COMMSFC")
+        {
+            strategy(COMMSFC);
+        }
         else
         {
             std::string msg("Unknown strategy: ");
@@ -158,6 +221,8 @@ DistributionMapping::Initialize ()
         strategy(m_Strategy);  // default
     }
 
+    build_node_of_rank();
+
     amrex::ExecOnFinalize(DistributionMapping::Finalize);
 
     initialized = true;
@@ -171,6 +236,8 @@ DistributionMapping::Finalize ()
     m_Strategy = SFC;
 
     DistributionMapping::m_BuildMap = 0;
+
+    node_of_rank.clear();
 }
 
 void
@@ -1327,6 +1394,312 @@ DistributionMapping::RRSFCProcessorMap (const BoxArray&          boxes,
     RRSFCDoIt(boxes,nprocs);
 }
 
+namespace
+{
+    //
+    // The number of cells two boxes exchange when filling ng ghost cells,
+    // summed over both directions.  Periodic images are not included.
+    //
+    std::vector<std::vector<std::pair<int,long> > >
+    halo_graph (const BoxArray& boxes, const IntVect& ng)
+    {
+        BL_PROFILE("DistributionMapping::halo_graph()");
+
+        const int nboxes = boxes.size();
+        std::vector<std::map<int,long> > g(nboxes);
+        std::vector<std::pair<int,Box> > isects;
+
+        for (int i = 0; i < nboxes; ++i)
+        {
+            boxes.intersections(amrex::grow(boxes[i],ng), isects);
+            for (const auto& is : isects)
+            {
+                if (is.first != i)
+                {
+                    const long n = is.second.numPts();
+                    g[i][is.first] += n;
+                    g[is.first][i] += n;
+                }
+            }
+        }
+
+        std::vector<std::vector<std::pair<int,long> > > r(nboxes);
+        for (int i = 0; i < nboxes; ++i) {
+            r[i].assign(g[i].begin(), g[i].end());
+        }
+        return r;
+    }
+}
+
+void
+DistributionMapping::CommSFCDoIt (const BoxArray&          boxes,
+                                  const std::vector<long>& wgts)
+{
+    BL_PROFILE("DistributionMapping::CommSFCDoIt()");
+
+#if defined (BL_USE_TEAM)
+    amrex::Abort("Team support is not implemented yet in COMMSFC");
+#endif
+
+    const int nprocs = ParallelContext::NProcsSub();
+    const int nboxes = boxes.size();
+    //
+    // The ranks of each node.
+    //
+    const Vector<int>& nodes = NodeOfRank();
+    std::map<int, std::vector<int> > ranks_of_node;
+    for (int i = 0; i < nprocs; ++i) {
+        ranks_of_node[nodes[ParallelContext::local_to_global_rank(i)]].push_back(i);
+    }
+    std::vector<std::vector<int> > node_ranks;
+    for (auto& kv : ranks_of_node) {
+        node_ranks.push_back(std::move(kv.second));
+    }
+    const int nnodes = node_ranks.size();
+
+    std::vector<SFCToken> tokens;
+    tokens.reserve(nboxes);
+
+    int maxijk = 0;
+    Real totalvol = 0;
+
+    for (int i = 0; i < nboxes; ++i)
+    {
+        const Box& bx = boxes[i];
+        tokens.push_back(SFCToken(i,bx.smallEnd(),wgts[i]));
+        totalvol += wgts[i];
+
+        const SFCToken& token = tokens.back();
+
+        AMREX_D_TERM(maxijk = std::max(maxijk, token.m_idx[0]);,
+                     maxijk = std::max(maxijk, token.m_idx[1]);,
+                     maxijk = std::max(maxijk, token.m_idx[2]););
+    }
+    //
+    // Set SFCToken::MaxPower for BoxArray.
+    //
+    int m = 0;
+    for ( ; (1 << m) <= maxijk; ++m) {
+        ;  // do nothing
+    }
+    SFCToken::MaxPower = m;
+    //
+    // Put'm in Morton space filling curve order.
+    //
+    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    //
+    // Cut the curve into one piece per node, sized by the node's number of ranks.
+    //
+    std::vector<Real> target(nnodes), load(nnodes, 0.0);
+    for (int n = 0; n < nnodes; ++n) {
+        target[n] = totalvol * node_ranks[n].size() / nprocs;
+    }
+
+    std::vector<int> node(nboxes);
+    {
+        int  n     = 0;
+        Real acc   = 0;
+        Real bound = target[0];
+        for (const auto& t : tokens)
+        {
+            while (n < nnodes-1 && acc + 0.5*t.m_vol > bound) {
+                bound += target[++n];
+            }
+            node[t.m_box] = n;
+            load[n] += t.m_vol;
+            acc += t.m_vol;
+        }
+    }
+    //
+    // Move boxes to the node they exchange the most halo data with, as long
+    // as the loads of both nodes stay within comm_tolerance of their targets.
+    // Every move strictly reduces the off-node halo, so this terminates.
+    //
+    if (nnodes > 1)
+    {
+        const auto graph = halo_graph(boxes, IntVect(AMREX_D_DECL(comm_ngrow,comm_ngrow,comm_ngrow)));
+
+        std::vector<long> conn(nnodes, 0L);
+        const int max_passes = 10;
+
+        for (int pass = 0; pass < max_passes; ++pass)
+        {
+            int nmoved = 0;
+
+            for (const auto& t : tokens)
+            {
+                const int i   = t.m_box;
+                const int src = node[i];
+
+                if (load[src] - t.m_vol < (1.0-comm_tolerance)*target[src]) continue;
+
+                for (const auto& e : graph[i]) {
+                    conn[node[e.first]] += e.second;
+                }
+
+                int  dst  = src;
+                long best = conn[src];
+                for (const auto& e : graph[i])
+                {
+                    const int n = node[e.first];
+                    if (conn[n] > best && load[n] + t.m_vol <= (1.0+comm_tolerance)*target[n])
+                    {
+                        best = conn[n];
+                        dst  = n;
+                    }
+                }
+
+                for (const auto& e : graph[i]) {
+                    conn[node[e.first]] = 0L;
+                }
+
+                if (dst != src)
+                {
+                    node[i] = dst;
+                    load[src] -= t.m_vol;
+                    load[dst] += t.m_vol;
+                    ++nmoved;
+                }
+            }
+
+            if (flag_verbose_mapper) {
+                Print() << "CommSFCDoIt: pass " << pass << " moved " << nmoved << " boxes" << std::endl;
+            }
+
+            if (nmoved == 0) break;
+        }
+    }
+    //
+    // Split the boxes of each node among its ranks along the curve.
+    //
+    for (int n = 0; n < nnodes; ++n)
+    {
+        std::vector<SFCToken> ntokens;
+        for (const auto& t : tokens) {
+            if (node[t.m_box] == n) {
+                ntokens.push_back(t);
+            }
+        }
+
+        const int nranks = node_ranks[n].size();
+        std::vector< std::vector<int> > vec(nranks);
+
+        Distribute(ntokens, nranks, load[n]/nranks, vec);
+
+        for (int r = 0; r < nranks; ++r) {
+            const int rank = ParallelContext::local_to_global_rank(node_ranks[n][r]);
+            for (int i : vec[r]) {
+                m_ref->m_pmap[i] = rank;
+            }
+        }
+    }
+
+    if (verbose)
+    {
+        std::vector<Real> rank_load(ParallelDescriptor::NProcs(), 0.0);
+        for (int i = 0; i < nboxes; ++i) {
+            rank_load[m_ref->m_pmap[i]] += wgts[i];
+        }
+        const Real max_load = *std::max_element(rank_load.begin(), rank_load.end());
+
+        const IntVect ng(AMREX_D_DECL(comm_ngrow,comm_ngrow,comm_ngrow));
+        const HaloCells h = EstimateHaloCells(boxes, *this, ng);
+
+        amrex::Print() << "COMMSFC efficiency: " << (totalvol/(nprocs*max_load))
+                       << ", nodes: " << nnodes
+                       << ", estimated halo cells on node: " << h.on_node
+                       << ", off node: " << h.off_node << '\n';
+    }
+}
+
+void
+DistributionMapping::CommSFCProcessorMap (const BoxArray& boxes,
+                                          int             nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(boxes.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(boxes,nprocs);
+    }
+    else
+    {
+        std::vector<long> wgts;
+
+        wgts.reserve(boxes.size());
+
+        for (int i = 0, N = boxes.size(); i < N; ++i)
+        {
+            wgts.push_back(boxes[i].volume());
+        }
+
+        CommSFCDoIt(boxes,wgts);
+    }
+}
+
+void
+DistributionMapping::CommSFCProcessorMap (const BoxArray&          boxes,
+                                          const std::vector<long>& wgts,
+                                          int                      nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs);
+    }
+    else
+    {
+        CommSFCDoIt(boxes,wgts);
+    }
+}
+
+const Vector<int>&
+DistributionMapping::NodeOfRank ()
+{
+    if (node_of_rank.empty()) {
+        amrex::Abort("DistributionMapping::NodeOfRank: not initialized");
+    }
+    return node_of_rank;
+}
+
+DistributionMapping::HaloCells
+DistributionMapping::EstimateHaloCells (const BoxArray& ba, const DistributionMapping& dm,
+                                        const IntVect& nghost)
+{
+    BL_PROFILE("DistributionMapping::EstimateHaloCells()");
+
+    const Vector<int>& nodes = NodeOfRank();
+
+    HaloCells r;
+    std::vector<std::pair<int,Box> > isects;
+
+    for (int i = 0, N = ba.size(); i < N; ++i)
+    {
+        const int rank = dm[i];
+        ba.intersections(amrex::grow(ba[i],nghost), isects);
+        for (const auto& is : isects)
+        {
+            const int src = dm[is.first];
+            if (src == rank) continue;
+            if (nodes[src] == nodes[rank]) {
+                r.on_node += is.second.numPts();
+            } else {
+                r.off_node += is.second.numPts();
+            }
+        }
+    }
+
+    return r;
+}
+
 DistributionMapping
 DistributionMapping::makeKnapSack (const Vector<Real>& rcost)
 {
@@ -1459,6 +1832,41 @@ DistributionMapping::makeSFC (const MultiFab& weight, bool sort)
     return r;
 }
 
+DistributionMapping
+DistributionMapping::makeCommSFC (const MultiFab& weight)
+{
+    DistributionMapping r;
+
+    Vector<long> cost(weight.size());
+#ifdef BL_USE_MPI
+    {
+	Vector<Real> rcost(cost.size(), 0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	for (MFIter mfi(weight); mfi.isValid(); ++mfi) {
+	    int i = mfi.index();
+	    rcost[i] = weight[mfi].sum(mfi.validbox(),0);
+	}
+
+	ParallelAllReduce::Sum(&rcost[0], rcost.size(), ParallelContext::CommunicatorSub());
+
+	Real wmax = *std::max_element(rcost.begin(), rcost.end());
+        Real scale = (wmax == 0) ? 1.e9 : 1.e9/wmax;
+
+	for (int i = 0; i < rcost.size(); ++i) {
+	    cost[i] = long(rcost[i]*scale) + 1L;
+	}
+    }
+#endif
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.CommSFCProcessorMap(weight.boxArray(), cost, nprocs);
+
+    return r;
+}
+
 std::vector<std::vector<int> >
 DistributionMapping::makeSFC (const BoxArray& ba, bool use_box_vol)
 {
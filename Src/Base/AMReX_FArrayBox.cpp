@@ -221,6 +221,28 @@ FArrayBox::initVal () noexcept
     }
 }
 
+void
+FArrayBox::initVal (const Box& bx) noexcept
+{
+    if (init_snan) {
+#if defined(BL_USE_DOUBLE) && !defined(AMREX_USE_GPU)
+        const auto a = array();
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        const std::size_t nx = hi.x-lo.x+1;
+        for             (int n = 0; n < nComp(); ++n) {
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    amrex_array_init_snan(a.ptr(lo.x,j,k,n), nx);
+                }
+            }
+        }
+#endif
+    } else if (do_initval) {
+	setVal(initval, bx, 0, nComp());
+    }
+}
+
 void
 FArrayBox::resize (const Box& b, int N)
 {
@@ -353,6 +375,20 @@ FArrayBox::get_initval ()
     return initval;
 }
 
+bool
+FArrayBox::set_init_snan (bool tf)
+{
+    bool o_tf = init_snan;
+    init_snan = tf;
+    return o_tf;
+}
+
+bool
+FArrayBox::get_init_snan ()
+{
+    return init_snan;
+}
+
 void
 FArrayBox::Initialize ()
 {
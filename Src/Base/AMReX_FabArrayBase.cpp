@@ -24,6 +24,9 @@ namespace amrex {
 // Set default values in Initialize()!!!
 //
 int     FabArrayBase::MaxComp;
+bool    FabArrayBase::UnpackAsReceived;
+bool    FabArrayBase::PersistentComm;
+bool    FabArrayBase::FirstTouch;
 
 #if defined(AMREX_USE_GPU) && defined(AMREX_USE_GPU_PRAGMA)
 
@@ -78,6 +81,11 @@ namespace
 {
     Arena* the_fa_arena = nullptr;
     bool initialized = false;
+#ifdef BL_USE_MPI
+    // CommPlan messages use their own communicator so that their fixed
+    // tags cannot match any other message.
+    MPI_Comm persistent_comm = MPI_COMM_NULL;
+#endif
 }
 
 void
@@ -90,6 +98,9 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::MaxComp           = 25;
+    FabArrayBase::UnpackAsReceived  = false;
+    FabArrayBase::PersistentComm    = false;
+    FabArrayBase::FirstTouch        = false;
 
     ParmParse pp("fabarray");
 
@@ -111,6 +122,9 @@ FabArrayBase::Initialize ()
     }
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
+    pp.query("unpack_as_received",  FabArrayBase::UnpackAsReceived);
+    pp.query("persistent_comm",     FabArrayBase::PersistentComm);
+    pp.query("first_touch",         FabArrayBase::FirstTouch);
 
     if (MaxComp < 1) {
         MaxComp = 1;
@@ -122,6 +136,12 @@ FabArrayBase::Initialize ()
         the_fa_arena = The_Pinned_Arena();
     }
 
+#ifdef BL_USE_MPI
+    if (PersistentComm) {
+        BL_MPI_REQUIRE( MPI_Comm_dup(ParallelDescriptor::Communicator(), &persistent_comm) );
+    }
+#endif
+
     amrex::ExecOnFinalize(FabArrayBase::Finalize);
 
 #ifdef AMREX_MEM_PROFILING
@@ -992,6 +1012,161 @@ FabArrayBase::FB::~FB ()
     delete m_RcvTags;
 }
 
+FabArrayBase::CommPlan::CommPlan (const MapOfCopyComTagContainers& snd_tags,
+                                  const MapOfCopyComTagContainers& rcv_tags,
+                                  int bytes_per_cell, int tag)
+    : m_bytes_per_cell(bytes_per_cell), m_tag(tag)
+{
+#ifdef BL_USE_MPI
+    BL_PROFILE("FabArrayBase::CommPlan::CommPlan()");
+
+    Vector<int> send_rank;
+
+    std::size_t send_volume = 0;
+    for (auto const& kv : snd_tags)
+    {
+        std::size_t nbytes = 0;
+        for (auto const& cct : kv.second) {
+            nbytes += cct.sbox.numPts() * bytes_per_cell;
+        }
+        BL_ASSERT(nbytes < std::numeric_limits<int>::max());
+        send_volume += nbytes;
+        m_send_size.push_back(static_cast<int>(nbytes));
+        m_send_cctc.push_back(&kv.second);
+        send_rank.push_back(kv.first);
+    }
+
+    std::size_t recv_volume = 0;
+    for (auto const& kv : rcv_tags)
+    {
+        std::size_t nbytes = 0;
+        for (auto const& cct : kv.second) {
+            nbytes += cct.dbox.numPts() * bytes_per_cell;
+        }
+        BL_ASSERT(nbytes < std::numeric_limits<int>::max());
+        recv_volume += nbytes;
+        m_recv_size.push_back(static_cast<int>(nbytes));
+        m_recv_cctc.push_back(&kv.second);
+        m_recv_from.push_back(kv.first);
+    }
+
+    if (send_volume > 0) {
+        m_the_send_data = static_cast<char*>(amrex::The_FA_Arena()->alloc(send_volume));
+    }
+    if (recv_volume > 0) {
+        m_the_recv_data = static_cast<char*>(amrex::The_FA_Arena()->alloc(recv_volume));
+    }
+    m_bytes = send_volume + recv_volume;
+
+    const int nsend = m_send_size.size();
+    m_send_data.resize(nsend, nullptr);
+    m_send_reqs.resize(nsend, MPI_REQUEST_NULL);
+    char* p = m_the_send_data;
+    for (int i = 0; i < nsend; ++i)
+    {
+        if (m_send_size[i] > 0)
+        {
+            m_send_data[i] = p;
+            p += m_send_size[i];
+            BL_MPI_REQUIRE( MPI_Send_init(m_send_data[i], m_send_size[i], MPI_CHAR,
+                                          send_rank[i], m_tag, persistent_comm,
+                                          &m_send_reqs[i]) );
+        }
+    }
+
+    const int nrecv = m_recv_size.size();
+    m_recv_data.resize(nrecv, nullptr);
+    m_recv_reqs.resize(nrecv, MPI_REQUEST_NULL);
+    p = m_the_recv_data;
+    for (int i = 0; i < nrecv; ++i)
+    {
+        if (m_recv_size[i] > 0)
+        {
+            m_recv_data[i] = p;
+            p += m_recv_size[i];
+            BL_MPI_REQUIRE( MPI_Recv_init(m_recv_data[i], m_recv_size[i], MPI_CHAR,
+                                          m_recv_from[i], m_tag, persistent_comm,
+                                          &m_recv_reqs[i]) );
+        }
+        else
+        {
+            m_recv_cctc[i] = nullptr;
+        }
+    }
+#endif
+}
+
+FabArrayBase::CommPlan::~CommPlan ()
+{
+#ifdef BL_USE_MPI
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized)
+    {
+        for (auto& req : m_send_reqs) {
+            if (req != MPI_REQUEST_NULL) MPI_Request_free(&req);
+        }
+        for (auto& req : m_recv_reqs) {
+            if (req != MPI_REQUEST_NULL) MPI_Request_free(&req);
+        }
+    }
+#endif
+    if (m_the_send_data) amrex::The_FA_Arena()->free(m_the_send_data);
+    if (m_the_recv_data) amrex::The_FA_Arena()->free(m_the_recv_data);
+}
+
+void
+FabArrayBase::CommPlan::startRecvs ()
+{
+#ifdef BL_USE_MPI
+    for (auto& req : m_recv_reqs) {
+        if (req != MPI_REQUEST_NULL) {
+            BL_MPI_REQUIRE( MPI_Start(&req) );
+        }
+    }
+#endif
+}
+
+void
+FabArrayBase::CommPlan::startSends ()
+{
+#ifdef BL_USE_MPI
+    for (auto& req : m_send_reqs) {
+        if (req != MPI_REQUEST_NULL) {
+            BL_MPI_REQUIRE( MPI_Start(&req) );
+        }
+    }
+#endif
+}
+
+FabArrayBase::CommPlan*
+FabArrayBase::getCommPlan (CommPlans& plans,
+                           const MapOfCopyComTagContainers& snd_tags,
+                           const MapOfCopyComTagContainers& rcv_tags,
+                           int bytes_per_cell, int tag, CacheStats& stats)
+{
+#ifdef BL_USE_MPI
+    if (persistent_comm == MPI_COMM_NULL) return nullptr;
+
+    for (auto& plan : plans)
+    {
+        if (plan->m_bytes_per_cell == bytes_per_cell)
+        {
+            if (plan->m_active) return nullptr;
+            stats.recordPlanUse();
+            return plan.get();
+        }
+    }
+
+    plans.emplace_back(new CommPlan(snd_tags, rcv_tags, bytes_per_cell, tag));
+    stats.recordPlanBuild(plans.back()->m_bytes);
+    stats.recordPlanUse();
+    return plans.back().get();
+#else
+    return nullptr;
+#endif
+}
+
 void
 FabArrayBase::flushFB (bool no_assertion) const
 {
@@ -1062,6 +1237,38 @@ FabArrayBase::getFB (const IntVect& nghost, const Periodicity& period,
     return *new_fb;
 }
 
+void
+FabArrayBase::printFBCommStats (const IntVect& nghost, const Periodicity& period) const
+{
+    BL_PROFILE("FabArrayBase::printFBCommStats()");
+
+    const long bytes_per_cell = nComp() * sizeof(Real);
+
+    const DistributionMapping::HaloCells est
+        = DistributionMapping::EstimateHaloCells(boxArray(), DistributionMap(), nghost);
+
+    const Vector<int>& nodes = DistributionMapping::NodeOfRank();
+    const int myproc = ParallelDescriptor::MyProc();
+
+    long sent[2] = {0L, 0L};  // on node, off node
+    const FB& TheFB = getFB(nghost, period);
+    for (const auto& kv : *TheFB.m_SndTags)
+    {
+        const int i = (nodes[kv.first] == nodes[myproc]) ? 0 : 1;
+        for (const auto& tag : kv.second) {
+            sent[i] += tag.sbox.numPts();
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(sent, 2, ParallelDescriptor::IOProcessorNumber());
+
+    amrex::Print() << "FillBoundary bytes sent between ranks, nghost = " << nghost
+                   << ", ncomp = " << nComp() << "\n"
+                   << "    on node : estimated " << est.on_node*bytes_per_cell
+                   << ", actual " << sent[0]*bytes_per_cell << "\n"
+                   << "    off node: estimated " << est.off_node*bytes_per_cell
+                   << ", actual " << sent[1]*bytes_per_cell << "\n";
+}
+
 FabArrayBase::FPinfo::FPinfo (const FabArrayBase& srcfa,
 			      const FabArrayBase& dstfa,
 			      const Box&          dstdomain,
@@ -1383,6 +1590,12 @@ FabArrayBase::Finalize ()
     FabArrayBase::flushCPCache();
     FabArrayBase::flushTileArrayCache();
 
+#ifdef BL_USE_MPI
+    if (persistent_comm != MPI_COMM_NULL) {
+        BL_MPI_REQUIRE( MPI_Comm_free(&persistent_comm) );
+    }
+#endif
+
     if (ParallelDescriptor::IOProcessor() && amrex::system::verbose > 1) {
 	m_FA_stats.print();
 	m_TAC_stats.print();
@@ -1,12 +1,32 @@
 
+#include <algorithm>
+
 #include <AMReX_MFIter.H>
 #include <AMReX_FabArray.H>
 #include <AMReX_FArrayBox.H>
+#include <AMReX_LayoutData.H>
+#include <AMReX_Utility.H>
 
 namespace amrex {
 
 int MFIter::nextDynamicIndex = std::numeric_limits<int>::min();
 
+Vector<LayoutData<Real>*> MFIter::cost_registry;
+
+void
+MFIter::RegisterCost (LayoutData<Real>* cost)
+{
+    AMREX_ASSERT(std::find(cost_registry.begin(), cost_registry.end(), cost) == cost_registry.end());
+    cost_registry.push_back(cost);
+}
+
+void
+MFIter::DeregisterCost (LayoutData<Real>* cost)
+{
+    cost_registry.erase(std::remove(cost_registry.begin(), cost_registry.end(), cost),
+                        cost_registry.end());
+}
+
 MFIter::MFIter (const FabArrayBase& fabarray_, 
 		unsigned char       flags_)
     :
@@ -313,6 +333,35 @@ MFIter::Initialize ()
 #endif
 
 	typ = fabArray.boxArray().ixType();
+
+        if (!cost_registry.empty())
+        {
+            const auto key = fabArray.getBDKey();
+            for (auto cost : cost_registry) {
+                if (cost->getBDKey() == key) {
+                    m_cost = cost;
+                    m_cost_t0 = amrex::second();
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void
+MFIter::addCost ()
+{
+    if (isValid())
+    {
+#ifdef AMREX_USE_GPU
+        Gpu::synchronize();
+#endif
+        const Real dt = amrex::second() - m_cost_t0;
+        Real& c = (*m_cost)[*this];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        c += dt;
     }
 }
 
@@ -465,6 +514,8 @@ MFIter::grownnodaltilebox (int dir, IntVect const& a_ng) const noexcept
 void
 MFIter::operator++ () noexcept
 {
+    if (m_cost) addCost();
+
 #ifdef _OPENMP
     if (dynamic)
     {
@@ -509,6 +560,8 @@ MFIter::operator++ () noexcept
         }
 #endif
     }
+
+    if (m_cost) m_cost_t0 = amrex::second();
 }
 
 #ifdef AMREX_USE_GPU
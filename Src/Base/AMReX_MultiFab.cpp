@@ -94,6 +94,125 @@ MultiFab::Dot (const iMultiFab& mask,
     return sm;
 }
 
+namespace {
+
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+Real
+weighted_dot (Box const& bx, Array4<Real const> const& x, int xcomp,
+              Array4<Real const> const& y, int ycomp,
+              Array4<Real const> const& w, int numcomp) noexcept
+{
+    const auto lo = amrex::lbound(bx);
+    const auto hi = amrex::ubound(bx);
+    Real r = 0.0;
+    for (int n = 0; n < numcomp; ++n) {
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                AMREX_PRAGMA_SIMD
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    r += w(i,j,k)*x(i,j,k,xcomp+n)*y(i,j,k,ycomp+n);
+                }
+            }
+        }
+    }
+    return r;
+}
+
+}
+
+void
+MultiFab::MultiDot (const Vector<const MultiFab*>& x, int xcomp,
+                    const Vector<const MultiFab*>& y, int ycomp,
+                    int numcomp, int nghost, Real* result,
+                    bool local, const MultiFab* weight)
+{
+    BL_PROFILE("MultiFab::MultiDot()");
+
+    const int npairs = x.size();
+    BL_ASSERT(static_cast<int>(y.size()) == npairs);
+
+    for (int m = 0; m < npairs; ++m) {
+        BL_ASSERT(x[m]->boxArray() == y[m]->boxArray());
+        BL_ASSERT(x[m]->DistributionMap() == y[m]->DistributionMap());
+        BL_ASSERT(x[m]->nGrow() >= nghost && y[m]->nGrow() >= nghost);
+        result[m] = 0.0;
+    }
+
+    Vector<int> done(npairs, 0);
+    Vector<int> group;
+    for (int m0 = 0; m0 < npairs; ++m0)
+    {
+        if (done[m0]) continue;
+
+        const BoxArray& ba = x[m0]->boxArray();
+        const DistributionMapping& dm = x[m0]->DistributionMap();
+        group.clear();
+        for (int m = m0; m < npairs; ++m) {
+            if (!done[m] && x[m]->boxArray() == ba && x[m]->DistributionMap() == dm) {
+                group.push_back(m);
+                done[m] = 1;
+            }
+        }
+        AMREX_ALWAYS_ASSERT(weight == nullptr || (weight->boxArray() == ba &&
+                                                  weight->DistributionMap() == dm &&
+                                                  weight->nGrow() >= nghost));
+        const int ng = group.size();
+
+#ifdef AMREX_USE_GPU
+        if (Gpu::inLaunchRegion())
+        {
+            for (int g = 0; g < ng; ++g) {
+                const int m = group[g];
+                if (weight) {
+                    result[m] = amrex::ReduceSum(*x[m], *y[m], *weight, nghost,
+                    [=] AMREX_GPU_HOST_DEVICE (Box const& bx, FArrayBox const& xfab,
+                                               FArrayBox const& yfab, FArrayBox const& wfab) -> Real
+                    {
+                        return weighted_dot(bx, xfab.const_array(), xcomp, yfab.const_array(), ycomp,
+                                            wfab.const_array(), numcomp);
+                    });
+                } else {
+                    result[m] = MultiFab::Dot(*x[m], xcomp, *y[m], ycomp, numcomp, nghost, true);
+                }
+            }
+        }
+        else
+#endif
+        {
+#ifdef _OPENMP
+#pragma omp parallel if (!system::regtest_reduction)
+#endif
+            {
+                Vector<Real> priv(ng, 0.0);
+                for (MFIter mfi(*x[m0],true); mfi.isValid(); ++mfi)
+                {
+                    const Box& bx = mfi.growntilebox(nghost);
+                    for (int g = 0; g < ng; ++g) {
+                        const int m = group[g];
+                        if (weight) {
+                            priv[g] += weighted_dot(bx, x[m]->const_array(mfi), xcomp,
+                                                    y[m]->const_array(mfi), ycomp,
+                                                    weight->const_array(mfi), numcomp);
+                        } else {
+                            priv[g] += (*x[m])[mfi].dot(bx, xcomp, (*y[m])[mfi], bx, ycomp, numcomp);
+                        }
+                    }
+                }
+#ifdef _OPENMP
+#pragma omp critical (multifab_multidot)
+#endif
+                for (int g = 0; g < ng; ++g) {
+                    result[group[g]] += priv[g];
+                }
+            }
+        }
+    }
+
+    if (!local && npairs > 0) {
+        ParallelAllReduce::Sum(result, npairs, ParallelContext::CommunicatorSub());
+    }
+}
+
 void
 MultiFab::Add (MultiFab&       dst,
 	       const MultiFab& src,
@@ -0,0 +1,66 @@
+
+#include <AMReX_NArena.H>
+#include <AMReX_NUMA.H>
+#include <AMReX.H>
+
+#include <sys/mman.h>
+
+namespace amrex {
+
+NArena::NArena (std::size_t min_map_size)
+    : m_min_map(min_map_size == 0 ? DefaultMinMapSize : min_map_size),
+      m_used(0)
+{}
+
+NArena::~NArena ()
+{
+    for (auto const& m : m_maps) {
+        munmap(m.first, m.second);
+    }
+}
+
+void*
+NArena::alloc (std::size_t nbytes)
+{
+    if (nbytes < m_min_map)
+    {
+        void* p = std::malloc(nbytes == 0 ? 1 : nbytes);
+        if (p == nullptr) amrex::Abort("Sorry, malloc failed");
+        return p;
+    }
+
+    const std::size_t ps = NUMA::pageSize();
+    const std::size_t N = (nbytes + ps - 1) / ps * ps;
+    void* p = mmap(nullptr, N, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) amrex::Abort("NArena: mmap failed");
+    m_used += N;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maps.emplace(p, N);
+    return p;
+}
+
+void
+NArena::free (void* vp)
+{
+    if (vp == nullptr) return;
+
+    std::size_t N = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_maps.find(vp);
+        if (it != m_maps.end()) {
+            N = it->second;
+            m_maps.erase(it);
+        }
+    }
+
+    if (N > 0) {
+        munmap(vp, N);
+        m_used -= N;
+    } else {
+        std::free(vp);
+    }
+}
+
+}
@@ -0,0 +1,148 @@
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+#include <AMReX_NUMA.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace amrex {
+namespace NUMA {
+
+std::size_t
+pageSize ()
+{
+#ifdef __linux__
+    static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+    return page_size;
+#else
+    return 4096;
+#endif
+}
+
+int
+numNodes ()
+{
+    static const int nnodes = [] () {
+        int n = 0;
+#ifdef __linux__
+        if (DIR* dir = opendir("/sys/devices/system/node")) {
+            while (dirent* e = readdir(dir)) {
+                int id;
+                if (std::sscanf(e->d_name, "node%d", &id) == 1) {
+                    n = std::max(n, id+1);
+                }
+            }
+            closedir(dir);
+        }
+#endif
+        return std::max(n, 1);
+    }();
+    return nnodes;
+}
+
+int
+threadNode ()
+{
+#ifdef __linux__
+    const int cpu = sched_getcpu();
+    if (cpu < 0) return -1;
+    const std::string cpudir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/node";
+    for (int nd = 0, N = numNodes(); nd < N; ++nd) {
+        if (access((cpudir + std::to_string(nd)).c_str(), F_OK) == 0) {
+            return nd;
+        }
+    }
+#endif
+    return -1;
+}
+
+void
+touchPages (void* p, std::size_t nbytes)
+{
+    if (nbytes == 0) return;
+    volatile char* c = static_cast<volatile char*>(p);
+    const std::size_t ps = pageSize();
+    for (std::size_t i = 0; i < nbytes; i += ps) {
+        c[i] = c[i];
+    }
+    c[nbytes-1] = c[nbytes-1];
+}
+
+void
+pageNodes (const Vector<const void*>& addr, Vector<int>& node)
+{
+    node.assign(addr.size(), -1);
+#if defined(__linux__) && defined(SYS_move_pages)
+    if (addr.empty()) return;
+    const std::uintptr_t mask = ~static_cast<std::uintptr_t>(pageSize()-1);
+    Vector<void*> pages(addr.size());
+    for (int i = 0, N = addr.size(); i < N; ++i) {
+        pages[i] = reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(addr[i]) & mask);
+    }
+    // With no target nodes, move_pages only reports where the pages are.
+    Vector<int> status(addr.size(), -1);
+    if (syscall(SYS_move_pages, 0, static_cast<unsigned long>(pages.size()),
+                pages.data(), nullptr, status.data(), 0) == 0)
+    {
+        for (int i = 0, N = addr.size(); i < N; ++i) {
+            if (status[i] >= 0) node[i] = status[i];
+        }
+    }
+#endif
+}
+
+void
+PrintPlacement (const Vector<Vector<const void*> >& addr,
+                const Vector<int>& node, const std::string& name)
+{
+    AMREX_ASSERT(addr.size() == node.size());
+
+    int nnodes = numNodes();
+    ParallelDescriptor::ReduceIntMax(nnodes);
+
+    // Not present, the nodes, and on the node of the thread
+    Vector<long> count(nnodes+2, 0L);
+    for (int t = 0; t < addr.size(); ++t) {
+        Vector<int> pnode;
+        pageNodes(addr[t], pnode);
+        for (int nd : pnode) {
+            ++count[nd+1];
+            if (nd >= 0 && nd == node[t]) ++count[nnodes+1];
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(count.data(), count.size());
+
+    long total = 0;
+    for (int i = 0; i <= nnodes; ++i) total += count[i];
+    const Real f = (total > 0) ? 100.0/total : 0.0;
+
+    amrex::Print() << "NUMA placement of " << name << ": " << total << " rows,";
+    for (int nd = 0; nd < nnodes; ++nd) {
+        amrex::Print() << " node " << nd << " " << count[nd+1]*f << "%,";
+    }
+    amrex::Print() << " not present or unknown " << count[0]*f << "%;"
+                   << " on the node of their thread " << count[nnodes+1]*f << "%\n";
+
+#ifdef _OPENMP
+    if (omp_get_max_threads() > 1 && omp_get_proc_bind() == omp_proc_bind_false) {
+        amrex::Print() << "NUMA placement of " << name
+                       << ": OpenMP threads are not bound to cpus, set OMP_PROC_BIND\n";
+    }
+#endif
+}
+
+}
+}
@@ -0,0 +1,103 @@
+
+#include <algorithm>
+
+#include <AMReX_ParallelReduce.H>
+#include <AMReX_BLProfiler.H>
+
+namespace amrex {
+
+DeferredAllReduce::~DeferredAllReduce ()
+{
+#if defined(BL_USE_MPI) && (MPI_VERSION >= 3)
+    // The registered locations may be gone, so the results are dropped.
+    if (m_started) {
+        MPI_Waitall(2, m_req, MPI_STATUSES_IGNORE);
+    }
+#endif
+}
+
+void
+DeferredAllReduce::addSum (Real* v, int n)
+{
+    AMREX_ASSERT(!m_started);
+    m_sums.push_back(std::make_pair(v,n));
+}
+
+void
+DeferredAllReduce::addMax (Real* v, int n)
+{
+    AMREX_ASSERT(!m_started);
+    m_maxs.push_back(std::make_pair(v,n));
+}
+
+void
+DeferredAllReduce::start ()
+{
+    AMREX_ASSERT(!m_started);
+    m_started = true;
+
+    m_nsum = 0;
+    for (const auto& p : m_sums) m_nsum += p.second;
+    m_nmax = 0;
+    for (const auto& p : m_maxs) m_nmax += p.second;
+
+    // The sums are followed by the maxima.
+    m_buf.resize(m_nsum + m_nmax);
+    int i = 0;
+    for (const auto& p : m_sums) {
+        std::copy(p.first, p.first+p.second, m_buf.data()+i);
+        i += p.second;
+    }
+    for (const auto& p : m_maxs) {
+        std::copy(p.first, p.first+p.second, m_buf.data()+i);
+        i += p.second;
+    }
+
+#if defined(BL_USE_MPI) && (MPI_VERSION >= 3)
+    const MPI_Datatype typ = ParallelDescriptor::Mpi_typemap<Real>::type();
+    if (m_nsum > 0) {
+        MPI_Iallreduce(MPI_IN_PLACE, m_buf.data(), m_nsum, typ, MPI_SUM, m_comm, &m_req[0]);
+    }
+    if (m_nmax > 0) {
+        MPI_Iallreduce(MPI_IN_PLACE, m_buf.data()+m_nsum, m_nmax, typ, MPI_MAX, m_comm, &m_req[1]);
+    }
+#endif
+}
+
+void
+DeferredAllReduce::wait ()
+{
+    BL_PROFILE("DeferredAllReduce::wait()");
+
+    if (!m_started) start();
+
+#ifdef BL_USE_MPI
+#if (MPI_VERSION >= 3)
+    MPI_Waitall(2, m_req, MPI_STATUSES_IGNORE);
+#else
+    const MPI_Datatype typ = ParallelDescriptor::Mpi_typemap<Real>::type();
+    if (m_nsum > 0) {
+        MPI_Allreduce(MPI_IN_PLACE, m_buf.data(), m_nsum, typ, MPI_SUM, m_comm);
+    }
+    if (m_nmax > 0) {
+        MPI_Allreduce(MPI_IN_PLACE, m_buf.data()+m_nsum, m_nmax, typ, MPI_MAX, m_comm);
+    }
+#endif
+#endif
+
+    int i = 0;
+    for (const auto& p : m_sums) {
+        std::copy(m_buf.data()+i, m_buf.data()+i+p.second, p.first);
+        i += p.second;
+    }
+    for (const auto& p : m_maxs) {
+        std::copy(m_buf.data()+i, m_buf.data()+i+p.second, p.first);
+        i += p.second;
+    }
+
+    m_sums.clear();
+    m_maxs.clear();
+    m_started = false;
+}
+
+}
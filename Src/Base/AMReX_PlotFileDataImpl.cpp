@@ -1,7 +1,11 @@
 #include <algorithm>
+#include <limits>
+#include <fstream>
 #include <AMReX_PlotFileDataImpl.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_VisMF.H>
+#include <AMReX_FabConv.H>
+#include <AMReX_FPC.H>
 
 namespace amrex {
 
@@ -127,19 +131,157 @@ MultiFab
 PlotFileDataImpl::get (int level, std::string const& varname) noexcept
 {
     MultiFab mf(m_ba[level], m_dmap[level], 1, m_ngrow[level]);
+    int icomp = compIndex(varname);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        int gid = mfi.index();
+        FArrayBox& dstfab = mf[mfi];
+        std::unique_ptr<FArrayBox> srcfab(m_vismf[level]->readFAB(gid, icomp));
+        dstfab.copy(*srcfab);
+    }
+    return mf;
+}
+
+int
+PlotFileDataImpl::compIndex (std::string const& varname) const noexcept
+{
     auto r = std::find(std::begin(m_var_names), std::end(m_var_names), varname);
     if (r == std::end(m_var_names)) {
         amrex::Abort("PlotFileDataImpl::get: varname not found "+varname);
+    }
+    return std::distance(std::begin(m_var_names), r);
+}
+
+FArrayBox
+PlotFileDataImpl::get (int level, std::string const& varname, Box const& region) noexcept
+{
+    return get(level, compIndex(varname), region);
+}
+
+FArrayBox
+PlotFileDataImpl::get (int level, int icomp, Box const& region) noexcept
+{
+    BL_PROFILE("PlotFileDataImpl::get(region)");
+
+    const BoxArray& ba = m_ba[level];
+    const Box bx = region & ba.minimalBox();
+    if (!bx.ok()) return FArrayBox();
+
+    FArrayBox fab(bx, 1);
+    fab.setVal(0.0);
+
+    // The grids intersecting the region are read by their owners, in the
+    // order they are in the files.
+    const VisMF::Header& hdr = m_vismf[level]->header();
+    const auto isects = ba.intersections(bx);
+    Vector<int> gids;
+    for (auto const& is : isects) {
+        if (m_dmap[level][is.first] == ParallelDescriptor::MyProc()) {
+            gids.push_back(is.first);
+        }
+    }
+    std::sort(gids.begin(), gids.end(), [&hdr] (int a, int b) {
+        return std::make_pair(hdr.m_fod[a].m_name, hdr.m_fod[a].m_head)
+            <  std::make_pair(hdr.m_fod[b].m_name, hdr.m_fod[b].m_head);
+    });
+
+    const std::string& mf_name = m_mf_name[level];
+    const std::string dir = mf_name.substr(0, mf_name.rfind('/')+1);
+    std::ifstream ifs;
+    std::string ifs_name;
+    for (int gid : gids) {
+        const CacheKey key(level, gid, icomp);
+        if (VisMF::NoFabHeader(hdr) && m_cache_map.find(key) == m_cache_map.end()) {
+            const std::string& fname = hdr.m_fod[gid].m_name;
+            if (fname != ifs_name) {
+                if (ifs.is_open()) ifs.close();
+                ifs.open(dir+fname, std::ios::in | std::ios::binary);
+                if (!ifs.good()) amrex::FileOpenFailed(dir+fname);
+                ifs_name = fname;
+            }
+            const int ncomp = std::min(1+m_readahead, m_ncomp-icomp);
+            readFabs(level, gid, icomp, ncomp, ifs);
+        }
+        // FABs with their own headers or compressed are read by VisMF in getFab.
+        const FArrayBox& src = getFab(level, gid, icomp);
+        const Box& b = ba[gid] & bx;
+        fab.copy(src, b, 0, b, 0, 1);
+    }
+
+    // Every process gets the whole region.
+    if (ParallelDescriptor::NProcs() > 1) {
+        const long npts = fab.box().numPts();
+        const int chunk = std::numeric_limits<int>::max();
+        for (long i = 0; i < npts; i += chunk) {
+            ParallelDescriptor::ReduceRealSum(fab.dataPtr()+i, std::min(npts-i, long(chunk)));
+        }
+    }
+
+    return fab;
+}
+
+void
+PlotFileDataImpl::setCacheSize (long nbytes) noexcept
+{
+    m_cache_size = nbytes;
+    while (m_cache_bytes > m_cache_size && !m_cache.empty()) {
+        m_cache_bytes -= m_cache.front().second->nBytes();
+        m_cache_map.erase(m_cache.front().first);
+        m_cache.pop_front();
+    }
+}
+
+FArrayBox const&
+PlotFileDataImpl::getFab (int level, int gid, int icomp) noexcept
+{
+    auto it = m_cache_map.find(CacheKey(level,gid,icomp));
+    if (it == m_cache_map.end()) {
+        std::unique_ptr<FArrayBox> fab(m_vismf[level]->readFAB(gid, icomp));
+        m_cache_bytes += fab->nBytes();
+        m_cache.emplace_back(CacheKey(level,gid,icomp), std::move(fab));
+        it = m_cache_map.emplace(CacheKey(level,gid,icomp), std::prev(m_cache.end())).first;
     } else {
-        int icomp = std::distance(std::begin(m_var_names), r);
-        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-            int gid = mfi.index();
-            FArrayBox& dstfab = mf[mfi];
-            std::unique_ptr<FArrayBox> srcfab(m_vismf[level]->readFAB(gid, icomp));
-            dstfab.copy(*srcfab);
+        // most recently used
+        m_cache.splice(m_cache.end(), m_cache, it->second);
+    }
+
+    // The one just used stays in the cache.
+    while (m_cache_bytes > m_cache_size && m_cache.size() > 1) {
+        m_cache_bytes -= m_cache.front().second->nBytes();
+        m_cache_map.erase(m_cache.front().first);
+        m_cache.pop_front();
+    }
+
+    return *(it->second->second);
+}
+
+void
+PlotFileDataImpl::readFabs (int level, int gid, int icomp, int ncomp, std::istream& is) noexcept
+{
+    const VisMF::Header& hdr = m_vismf[level]->header();
+    Box fab_box = hdr.m_ba[gid];
+    if (hdr.m_ngrow.max() > 0) fab_box.grow(hdr.m_ngrow);
+
+    // The components of a FAB are contiguous on disk, so the read-ahead
+    // components come with the same read.
+    const long bytes_per_comp = fab_box.numPts() * hdr.m_writtenRD.numBytes();
+    is.seekg(hdr.m_fod[gid].m_head + bytes_per_comp*icomp, std::ios::beg);
+    for (int n = icomp; n < icomp+ncomp; ++n) {
+        std::unique_ptr<FArrayBox> fab(new FArrayBox(fab_box, 1));
+        if (hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
+            is.read((char *) fab->dataPtr(), bytes_per_comp);
+        } else {
+            RealDescriptor::convertToNativeFormat(fab->dataPtr(), fab_box.numPts(), is, hdr.m_writtenRD);
+        }
+        if (!is.good()) amrex::Abort("PlotFileDataImpl::get: failed to read "+m_mf_name[level]);
+
+        const CacheKey key(level, gid, n);
+        auto it = m_cache_map.find(key);
+        if (it == m_cache_map.end()) {
+            m_cache_bytes += fab->nBytes();
+            m_cache.emplace_back(key, std::move(fab));
+            m_cache_map.emplace(key, std::prev(m_cache.end()));
         }
     }
-    return mf;
 }
 
 }
@@ -2,7 +2,10 @@
 #include <fstream>
 #include <iomanip>
 
+#include <sstream>
+
 #include <AMReX_VisMF.H>
+#include <AMReX_AsyncOut.H>
 #include <AMReX_PlotFileUtil.H>
 
 #ifdef AMREX_USE_EB
@@ -172,6 +175,11 @@ WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
 //    int saveNFiles(VisMF::GetNOutFiles());
 //    VisMF::SetNOutFiles(std::max(1024,saveNFiles));
 
+    const bool async_out = AsyncOut::UseAsyncOut();
+    if (async_out) {
+        AsyncOut::Begin();
+    }
+
     bool callBarrier(false);
     PreBuildDirectorHierarchy(plotfilename, levelPrefix, nlevels, callBarrier);
     if (!extra_dirs.empty()) {
@@ -182,7 +190,17 @@ WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
     }
     ParallelDescriptor::Barrier();
 
-    if (ParallelDescriptor::IOProcessor()) {
+    if (async_out && ParallelDescriptor::IOProcessor()) {
+      std::ostringstream HeaderFile;
+      Vector<BoxArray> boxArrays(nlevels);
+      for(int level(0); level < boxArrays.size(); ++level) {
+	boxArrays[level] = mf[level]->boxArray();
+      }
+      WriteGenericPlotfileHeader(HeaderFile, nlevels, boxArrays, varnames,
+                                 geom, time, level_steps, ref_ratio, versionName, levelPrefix, mfPrefix);
+      AsyncOut::Add(AsyncOut::WriteFileAsync(plotfilename + "/Header", HeaderFile.str()));
+    }
+    else if (ParallelDescriptor::IOProcessor()) {
       VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
       std::string HeaderFileName(plotfilename + "/Header");
       std::ofstream HeaderFile;
@@ -218,7 +236,11 @@ WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
         } else {
             data = mf[level];
         }
-	VisMF::Write(*data, MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix));
+        VisMF::WriteMaybeAsync(*data, MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix));
+    }
+
+    if (async_out) {
+        AsyncOut::End();
     }
 
 //    VisMF::SetNOutFiles(saveNFiles);
@@ -0,0 +1,233 @@
+#include <algorithm>
+
+#include <AMReX_SArena.H>
+#include <AMReX_BLassert.H>
+#include <AMReX.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace amrex {
+
+constexpr std::size_t SArena::header_size;
+constexpr std::size_t SArena::min_class_size;
+constexpr int SArena::thread_cache_max;
+
+namespace {
+    inline int highest_bit (std::size_t x) noexcept
+    {
+        int p = 0;
+        while (x >>= 1) ++p;
+        return p;
+    }
+}
+
+int
+SArena::size_class (std::size_t nbytes) noexcept
+{
+    //
+    // Classes are (4+m) << (o+4) bytes for octave o and m = 0,1,2,3.
+    // Round nbytes up to the closest one.
+    //
+    nbytes = std::max(nbytes, min_class_size);
+    const std::size_t s = nbytes-1;
+    int shift = highest_bit(s) - 2;
+    std::size_t q = (s >> shift) + 1;
+    if (q == 8) {
+        q = 4;
+        ++shift;
+    }
+    return (shift-4)*4 + static_cast<int>(q-4);
+}
+
+std::size_t
+SArena::class_size (int c) noexcept
+{
+    return static_cast<std::size_t>(4 + c%4) << (c/4 + 4);
+}
+
+SArena::SArena (std::size_t hunk_size, std::size_t max_class_size, ArenaInfo info)
+    : m_used(0)
+{
+    static_assert(sizeof(Header) <= header_size, "SArena: header too big");
+
+    arena_info = info;
+
+    m_hunk = Arena::align(hunk_size == 0 ? DefaultHunkSize : hunk_size);
+    m_max_class_size = (max_class_size == 0) ? DefaultMaxClassSize : max_class_size;
+    m_max_class_size = std::max(m_max_class_size, min_class_size);
+
+    // Largest class not exceeding m_max_class_size
+    m_nclasses = size_class(m_max_class_size);
+    if (class_size(m_nclasses) > m_max_class_size) {
+        --m_nclasses;
+    }
+    ++m_nclasses;
+    m_max_class_size = class_size(m_nclasses-1);
+
+    m_bins = std::vector<Bin>(m_nclasses);
+
+#ifdef _OPENMP
+    const int nthreads = omp_get_max_threads();
+#else
+    const int nthreads = 1;
+#endif
+    m_caches = std::vector<ThreadCache>(nthreads);
+    for (auto& tc : m_caches) {
+        tc.m_free.resize(m_nclasses);
+    }
+}
+
+SArena::~SArena ()
+{
+    for (unsigned int i = 0, N = m_alloc.size(); i < N; i++) {
+        deallocate_system(m_alloc[i].first, m_alloc[i].second);
+    }
+}
+
+SArena::ThreadCache&
+SArena::threadCache ()
+{
+#ifdef _OPENMP
+    // Threads not created by OpenMP share slot 0 with the master thread,
+    // which is safe because every cache has its own lock.
+    const int tid = omp_get_thread_num();
+    return m_caches[tid % m_caches.size()];
+#else
+    return m_caches[0];
+#endif
+}
+
+void*
+SArena::alloc (std::size_t nbytes)
+{
+    nbytes = (nbytes == 0) ? 1 : nbytes;
+
+    char* block;
+
+    if (nbytes > m_max_class_size)
+    {
+        const std::size_t N = Arena::align(nbytes) + header_size;
+        block = static_cast<char*>(allocate_system(N));
+        m_used += N;
+        Header* h = reinterpret_cast<Header*>(block);
+        h->m_size = N;
+        h->m_class = -1;
+    }
+    else
+    {
+        const int c = size_class(nbytes);
+        ThreadCache& tc = threadCache();
+        std::lock_guard<std::mutex> lock(tc.m_mutex);
+        auto& fl = tc.m_free[c];
+        if (fl.empty()) {
+            refill(tc, c);
+        }
+        block = static_cast<char*>(fl.back());
+        fl.pop_back();
+    }
+
+    return block + header_size;
+}
+
+void
+SArena::free (void* vp)
+{
+    if (vp == nullptr) return;
+
+    char* block = static_cast<char*>(vp) - header_size;
+    const Header* h = reinterpret_cast<const Header*>(block);
+    const int c = h->m_class;
+
+    if (c < 0)
+    {
+        const std::size_t N = h->m_size;
+        m_used -= N;
+        deallocate_system(block, N);
+    }
+    else
+    {
+        BL_ASSERT(c < m_nclasses);
+        ThreadCache& tc = threadCache();
+        std::lock_guard<std::mutex> lock(tc.m_mutex);
+        auto& fl = tc.m_free[c];
+        fl.push_back(block);
+        const int cache_max = std::max(1, std::min(thread_cache_max,
+                                                   static_cast<int>(m_hunk/class_size(c))));
+        if (static_cast<int>(fl.size()) > cache_max) {
+            drain(tc, c);
+        }
+    }
+}
+
+void
+SArena::refill (ThreadCache& tc, int c)
+{
+    const std::size_t bsize = class_size(c) + header_size;
+    const int cache_max = std::max(1, std::min(thread_cache_max,
+                                               static_cast<int>(m_hunk/class_size(c))));
+    const int nwant = std::max(1, cache_max/2);
+    auto& fl = tc.m_free[c];
+
+    {
+        Bin& bin = m_bins[c];
+        std::lock_guard<std::mutex> lock(bin.m_mutex);
+        const int n = std::min(nwant, static_cast<int>(bin.m_free.size()));
+        if (n > 0) {
+            fl.insert(fl.end(), bin.m_free.end()-n, bin.m_free.end());
+            bin.m_free.resize(bin.m_free.size()-n);
+            return;
+        }
+    }
+
+    //
+    // Carve a new slab into blocks of this class.
+    //
+    const int nblocks = static_cast<int>(std::max(std::size_t(1),
+                                                  std::min(std::size_t(256), m_hunk/bsize)));
+    const std::size_t N = nblocks*bsize;
+    char* slab = static_cast<char*>(allocate_system(N));
+    m_used += N;
+    {
+        std::lock_guard<std::mutex> lock(m_alloc_mutex);
+        m_alloc.push_back(std::make_pair(static_cast<void*>(slab),N));
+    }
+
+    for (int i = 0; i < nblocks; ++i) {
+        Header* h = reinterpret_cast<Header*>(slab + i*bsize);
+        h->m_size = bsize;
+        h->m_class = c;
+    }
+
+    const int nkeep = std::min(nwant, nblocks);
+    for (int i = 0; i < nkeep; ++i) {
+        fl.push_back(slab + i*bsize);
+    }
+    if (nblocks > nkeep) {
+        Bin& bin = m_bins[c];
+        std::lock_guard<std::mutex> lock(bin.m_mutex);
+        for (int i = nkeep; i < nblocks; ++i) {
+            bin.m_free.push_back(slab + i*bsize);
+        }
+    }
+}
+
+void
+SArena::drain (ThreadCache& tc, int c)
+{
+    auto& fl = tc.m_free[c];
+    const int n = static_cast<int>(fl.size())/2 + 1;
+    Bin& bin = m_bins[c];
+    std::lock_guard<std::mutex> lock(bin.m_mutex);
+    bin.m_free.insert(bin.m_free.end(), fl.end()-n, fl.end());
+    fl.resize(fl.size()-n);
+}
+
+std::size_t
+SArena::heap_space_used () const noexcept
+{
+    return m_used;
+}
+
+}
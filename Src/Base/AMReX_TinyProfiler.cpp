@@ -5,6 +5,8 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <fstream>
+#include <functional>
 #include <set>
 
 #include <AMReX_TinyProfiler.H>
@@ -12,6 +14,7 @@
 #include <AMReX_ParallelReduce.H>
 #include <AMReX_Utility.H>
 #include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -20,13 +23,14 @@
 namespace amrex {
 
 std::vector<std::string>          TinyProfiler::regionstack;
-std::deque<std::tuple<double,double,std::string*> > TinyProfiler::ttstack;
-std::map<std::string,std::map<std::string, TinyProfiler::Stats> > TinyProfiler::statsmap;
+std::vector<std::unique_ptr<TinyProfiler::ThreadData> > TinyProfiler::threaddata;
 double TinyProfiler::t_init = std::numeric_limits<double>::max();
+std::string TinyProfiler::output_file;
 
 namespace {
-    std::set<std::string> improperly_nested_timers;
     static constexpr char mainregion[] = "main";
+    //! separates the names in the call paths that are sent between processes
+    static constexpr char pathsep = '\x1f';
 }
 
 TinyProfiler::TinyProfiler (std::string funcname) noexcept
@@ -61,15 +65,38 @@ TinyProfiler::~TinyProfiler ()
 void
 TinyProfiler::start () noexcept
 {
-#ifdef _OPENMP
-#pragma omp master
-#endif
     if (stats.empty() && !regionstack.empty())
     {
+#ifdef _OPENMP
+        // thread numbers are not unique in nested parallel regions
+        if (omp_get_active_level() > 1) return;
+        // in a serialized region nested in an active one, omp_get_thread_num is 0 on all
+        // threads; use the thread number in the active region instead
+        for (int lev = omp_get_level(); lev > 0; --lev) {
+            if (omp_get_team_size(lev) > 1) {
+                thread_num = omp_get_ancestor_thread_num(lev);
+                break;
+            }
+        }
+#endif
+        if (thread_num >= static_cast<int>(threaddata.size())) return;
+        ThreadData& td = *threaddata[thread_num];
+
 	double t = amrex::second();
 
-	ttstack.emplace_back(std::make_tuple(t, 0.0, &fname));
-	global_depth = ttstack.size();
+        const int parent = td.ttstack.empty() ? 0 : td.ttstack.back().node;
+        int node;
+        auto it = td.calltree[parent].children.find(fname);
+        if (it != td.calltree[parent].children.end()) {
+            node = it->second;
+        } else {
+            node = td.calltree.size();
+            td.calltree.emplace_back(fname, parent);
+            td.calltree[parent].children[fname] = node;
+        }
+
+	td.ttstack.push_back(TimerEntry{t, 0.0, &fname, node});
+	global_depth = td.ttstack.size();
 
 #ifdef AMREX_USE_CUDA
 	nvtx_id = nvtxRangeStartA(fname.c_str());
@@ -77,7 +104,7 @@ TinyProfiler::start () noexcept
 
         for (auto const& region : regionstack)
         {
-            Stats& st = statsmap[region][fname];
+            Stats& st = td.statsmap[region][fname];
             ++st.depth;
             stats.push_back(&st);
         }
@@ -87,26 +114,23 @@ TinyProfiler::start () noexcept
 void
 TinyProfiler::stop () noexcept
 {
-#ifdef _OPENMP
-#pragma omp master
-#endif
     if (!stats.empty()) 
     {
 	double t = amrex::second();
 
+        ThreadData& td = *threaddata[thread_num];
+        auto& ttstack = td.ttstack;
+
 	while (static_cast<int>(ttstack.size()) > global_depth) {
 	    ttstack.pop_back();
 	};
 
 	if (static_cast<int>(ttstack.size()) == global_depth)
 	{
-	    const std::tuple<double,double,std::string*>& tt = ttstack.back();
-	    
-	    // first: wall time when the pair is pushed into the stack
-	    // second: accumulated dt of children
+	    const TimerEntry& tt = ttstack.back();
 	    
-	    double dtin = t - std::get<0>(tt); // elapsed time since start() is called.
-	    double dtex = dtin - std::get<1>(tt);
+	    double dtin = t - tt.t0; // elapsed time since start() is called.
+	    double dtex = dtin - tt.dtchild;
 
             for (Stats* st : stats)
             {
@@ -117,18 +141,22 @@ TinyProfiler::stop () noexcept
                 }
                 st->dtex += dtex;
             }
+
+            Stats& nst = td.calltree[tt.node].st;
+            ++nst.n;
+            nst.dtin += dtin;
+            nst.dtex += dtex;
                 
 	    ttstack.pop_back();
 	    if (!ttstack.empty()) {
-		std::tuple<double,double,std::string*>& parent = ttstack.back();
-		std::get<1>(parent) += dtin;
+		ttstack.back().dtchild += dtin;
 	    }
 
 #ifdef AMREX_USE_CUDA
 	    nvtxRangeEnd(nvtx_id);
 #endif
 	} else {
-	    improperly_nested_timers.insert(fname);
+	    td.improperly_nested_timers.insert(fname);
 	} 
 
         stats.clear();
@@ -139,6 +167,20 @@ void
 TinyProfiler::Initialize () noexcept
 {
     regionstack.push_back(mainregion);
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    threaddata.clear();
+    for (int i = 0; i < nthreads; ++i) {
+        threaddata.emplace_back(new ThreadData);
+        threaddata.back()->calltree.emplace_back(mainregion, -1);
+    }
+
+    ParmParse pp("tiny_profiler");
+    pp.query("output_file", output_file);
+
     t_init = amrex::second();
 }
 
@@ -156,8 +198,32 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
 
     double t_final = amrex::second();
 
-    // make a local copy so that any functions call after this will not be recorded in the local copy.
-    auto lstatsmap = statsmap;
+    // Merge the threads into a local copy, so that any functions called after this will not
+    // be recorded in it.  On each process, a function has the calls of all threads and the
+    // time of the slowest thread.
+    const int nthreads = threaddata.size();
+    std::map<std::string,std::map<std::string, Stats> > lstatsmap;
+    std::map<std::string,std::vector<Stats> > thrstats;
+    std::set<std::string> improperly_nested_timers;
+    for (int it = 0; it < nthreads; ++it)
+    {
+        ThreadData const& td = *threaddata[it];
+        for (auto const& reg : td.statsmap) {
+            for (auto const& kv : reg.second) {
+                Stats& st = lstatsmap[reg.first][kv.first];
+                st.n += kv.second.n;
+                st.dtin = std::max(st.dtin, kv.second.dtin);
+                st.dtex = std::max(st.dtex, kv.second.dtex);
+                if (reg.first == mainregion) {
+                    auto& v = thrstats[kv.first];
+                    v.resize(nthreads);
+                    v[it] = kv.second;
+                }
+            }
+        }
+        improperly_nested_timers.insert(td.improperly_nested_timers.begin(),
+                                        td.improperly_nested_timers.end());
+    }
 
     bool properly_nested = improperly_nested_timers.size() == 0;
     ParallelDescriptor::ReduceBoolAnd(properly_nested);
@@ -228,6 +294,16 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
             amrex::Print() << "END REGION " << kv.first << "\n";
         }
     }
+
+    int maxthreads = nthreads;
+    ParallelDescriptor::ReduceIntMax(maxthreads);
+    if (maxthreads > 1) {
+        PrintThreadStats(thrstats);
+    }
+
+    if (!output_file.empty()) {
+        WriteCallTree(t_final - t_init);
+    }
 }
 
 void
@@ -377,6 +453,290 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
     }
 }
 
+namespace {
+    // Spread of the time of a function across the threads of a process.  If more than
+    // one thread ran it, the threads that did not count as zero, because that is time
+    // they spent waiting for the others.
+    void threadSpread (const std::vector<double>& dt, const std::vector<long>& n,
+                       double& tmin, double& tavg, double& tmax)
+    {
+        const int nthreads = dt.size();
+        int nran = 0;
+        for (auto x : n) { if (x > 0) ++nran; }
+        tmin = std::numeric_limits<double>::max();
+        tavg = 0.0;
+        tmax = 0.0;
+        int cnt = 0;
+        for (int i = 0; i < nthreads; ++i) {
+            if (nran > 1 || n[i] > 0) {
+                tmin = std::min(tmin, dt[i]);
+                tavg += dt[i];
+                tmax = std::max(tmax, dt[i]);
+                ++cnt;
+            }
+        }
+        if (cnt > 0) {
+            tavg /= cnt;
+        } else {
+            tmin = 0.0;
+        }
+    }
+
+    std::string jsonString (const std::string& s)
+    {
+        std::string r("\"");
+        for (char c : s) {
+            if (c == '"' || c == '\\') r += '\\';
+            r += c;
+        }
+        return r + "\"";
+    }
+}
+
+void
+TinyProfiler::PrintThreadStats (const std::map<std::string,std::vector<Stats> >& thrstats)
+{
+    // the functions that ran on more than one thread on any process
+    Vector<std::string> localNames, names;
+    for (auto const& kv : thrstats) {
+        int nran = 0;
+        for (auto const& st : kv.second) { if (st.n > 0) ++nran; }
+        if (nran > 1) localNames.push_back(kv.first);
+    }
+    bool alreadySynced;
+    amrex::SyncStrings(localNames, names, alreadySynced);
+    std::sort(names.begin(), names.end());
+
+    const int nnames = names.size();
+    if (nnames == 0) return;
+
+    int nprocs = ParallelDescriptor::NProcs();
+    int ioproc = ParallelDescriptor::IOProcessorNumber();
+
+    std::vector<double> tmin(nnames, 0.0), tavg(nnames, 0.0), tmax(nnames, 0.0);
+    for (int i = 0; i < nnames; ++i) {
+        auto it = thrstats.find(names[i]);
+        if (it != thrstats.end()) {
+            std::vector<double> dt;
+            std::vector<long> n;
+            for (auto const& st : it->second) {
+                dt.push_back(st.dtin);
+                n.push_back(st.n);
+            }
+            threadSpread(dt, n, tmin[i], tavg[i], tmax[i]);
+        }
+    }
+
+    ParallelReduce::Min(tmin.data(), nnames, ioproc, ParallelDescriptor::Communicator());
+    ParallelReduce::Sum(tavg.data(), nnames, ioproc, ParallelDescriptor::Communicator());
+    ParallelReduce::Max(tmax.data(), nnames, ioproc, ParallelDescriptor::Communicator());
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::vector<int> order(nnames);
+        for (int i = 0; i < nnames; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&] (int a, int b) { return tmax[a] > tmax[b]; });
+
+        int maxfnamelen = 0;
+        for (auto const& name : names) maxfnamelen = std::max(maxfnamelen, int(name.size()));
+        const int wt = 11;
+        const std::string hline(maxfnamelen+(wt+2)*4,'-');
+
+        amrex::OutStream() << std::setfill(' ') << std::setprecision(4);
+        amrex::OutStream() << "\nInclusive time across the threads of each process\n"
+                           << hline << "\n"
+                           << std::left << std::setw(maxfnamelen) << "Name"
+                           << std::right
+                           << std::setw(wt+2) << "Thread Min"
+                           << std::setw(wt+2) << "Thread Avg"
+                           << std::setw(wt+2) << "Thread Max"
+                           << std::setw(wt+2) << "Max/Avg"
+                           << "\n" << hline << "\n";
+        for (int i : order)
+        {
+            const double avg = tavg[i]/nprocs;
+            amrex::OutStream() << std::setprecision(4) << std::left
+                               << std::setw(maxfnamelen) << names[i]
+                               << std::right
+                               << std::setw(wt+2) << tmin[i]
+                               << std::setw(wt+2) << avg
+                               << std::setw(wt+2) << tmax[i]
+                               << std::setw(wt+2) << ((avg > 0.0) ? tmax[i]/avg : 1.0)
+                               << "\n";
+        }
+        amrex::OutStream() << hline << "\n" << std::endl;
+    }
+}
+
+void
+TinyProfiler::WriteCallTree (double dt_proc)
+{
+    const int nthreads = threaddata.size();
+
+    // The call paths of this process, with the stats of each thread.  Worker threads
+    // start their trees inside parallel regions, so their top-level functions are put
+    // below the first place the master thread called the same function.
+    std::map<std::string, std::vector<Stats> > pathstats;
+
+    std::function<void(const std::vector<CallNode>&, int, const std::string&, int)> addSubtree;
+    addSubtree = [&] (const std::vector<CallNode>& tree, int node, const std::string& prefix, int it)
+    {
+        const std::string path = prefix.empty() ? tree[node].name : prefix + pathsep + tree[node].name;
+        auto& v = pathstats[path];
+        v.resize(nthreads);
+        v[it].n    += tree[node].st.n;
+        v[it].dtin += tree[node].st.dtin;
+        v[it].dtex += tree[node].st.dtex;
+        for (auto const& kv : tree[node].children) {
+            addSubtree(tree, kv.second, path, it);
+        }
+    };
+
+    {
+        auto const& tree = threaddata[0]->calltree;
+        addSubtree(tree, 0, "", 0);
+        auto& root = pathstats[mainregion][0];
+        root.n = 1;
+        root.dtin = dt_proc;
+        root.dtex = dt_proc;
+        for (auto const& kv : tree[0].children) root.dtex -= tree[kv.second].st.dtin;
+    }
+
+    std::map<std::string, std::string> firstpath;
+    for (auto const& kv : pathstats) {
+        const auto pos = kv.first.rfind(pathsep);
+        if (pos == std::string::npos) continue;
+        const std::string name = kv.first.substr(pos+1);
+        auto it = firstpath.find(name);
+        // the shallowest place the master thread called it
+        if (it == firstpath.end() || it->second.size() > pos) firstpath[name] = kv.first.substr(0,pos);
+    }
+
+    for (int it = 1; it < nthreads; ++it) {
+        auto const& tree = threaddata[it]->calltree;
+        for (auto const& kv : tree[0].children) {
+            auto f = firstpath.find(kv.first);
+            addSubtree(tree, kv.second, (f != firstpath.end()) ? f->second : std::string(mainregion), it);
+        }
+    }
+
+    // the same paths, in the same order, on all processes
+    Vector<std::string> localPaths, paths;
+    for (auto const& kv : pathstats) localPaths.push_back(kv.first);
+    bool alreadySynced;
+    amrex::SyncStrings(localPaths, paths, alreadySynced);
+    std::sort(paths.begin(), paths.end());
+    const int npaths = paths.size();
+
+    // [ncalls, incl, excl, thread incl], each for the min, sum and max across processes
+    std::vector<double> vmin(3*npaths, 0.0), vsum(4*npaths, 0.0), vmax(3*npaths, 0.0);
+    for (int i = 0; i < npaths; ++i) {
+        auto f = pathstats.find(paths[i]);
+        if (f == pathstats.end()) continue;
+        long n = 0;
+        double dtin = 0.0, dtex = 0.0;
+        std::vector<double> dt;
+        std::vector<long> nt;
+        for (auto const& st : f->second) {
+            n += st.n;
+            dtin = std::max(dtin, st.dtin);
+            dtex = std::max(dtex, st.dtex);
+            dt.push_back(st.dtin);
+            nt.push_back(st.n);
+        }
+        double tmin, tavg, tmax;
+        threadSpread(dt, nt, tmin, tavg, tmax);
+        vmin[3*i] = dtin;  vsum[4*i+1] = dtin;  vmax[3*i]   = dtin;
+        vmin[3*i+1] = dtex;  vsum[4*i+2] = dtex;  vmax[3*i+1] = dtex;
+        vmin[3*i+2] = tmin;  vsum[4*i+3] = tavg;  vmax[3*i+2] = tmax;
+        vsum[4*i] = n;
+    }
+
+    int nprocs = ParallelDescriptor::NProcs();
+    int ioproc = ParallelDescriptor::IOProcessorNumber();
+    ParallelReduce::Min(vmin.data(), vmin.size(), ioproc, ParallelDescriptor::Communicator());
+    ParallelReduce::Sum(vsum.data(), vsum.size(), ioproc, ParallelDescriptor::Communicator());
+    ParallelReduce::Max(vmax.data(), vmax.size(), ioproc, ParallelDescriptor::Communicator());
+
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    std::ofstream ofs(output_file);
+    if (!ofs.good()) {
+        amrex::Print() << "TinyProfiler: cannot open " << output_file << "\n";
+        return;
+    }
+    ofs << std::setprecision(8);
+
+    auto stat = [&] (int i, int k) {
+        return std::vector<double>{vmin[3*i+k], vsum[4*i+k+1]/nprocs, vmax[3*i+k]};
+    };
+
+    const bool csv = output_file.size() >= 4
+        && output_file.compare(output_file.size()-4, 4, ".csv") == 0;
+
+    if (csv)
+    {
+        ofs << "path,depth,ncalls,incl_min,incl_avg,incl_max,excl_min,excl_avg,excl_max,"
+            << "thread_incl_min,thread_incl_avg,thread_incl_max\n";
+        for (int i = 0; i < npaths; ++i) {
+            std::string path = paths[i];
+            const int depth = std::count(path.begin(), path.end(), pathsep);
+            std::replace(path.begin(), path.end(), pathsep, '/');
+            std::string quoted("\"");
+            for (char c : path) {
+                if (c == '"') quoted += '"';
+                quoted += c;
+            }
+            ofs << quoted << "\"," << depth << "," << vsum[4*i]/nprocs;
+            for (int k = 0; k < 3; ++k) {
+                for (auto x : stat(i,k)) ofs << "," << x;
+            }
+            ofs << "\n";
+        }
+    }
+    else
+    {
+        // paths sort before their children, since the separator sorts before any name
+        std::map<std::string,int> index;
+        std::vector<std::vector<int> > children(npaths);
+        for (int i = 0; i < npaths; ++i) {
+            index[paths[i]] = i;
+            const auto pos = paths[i].rfind(pathsep);
+            if (pos != std::string::npos) {
+                auto p = index.find(paths[i].substr(0,pos));
+                if (p != index.end()) children[p->second].push_back(i);
+            }
+        }
+
+        const char* statname[] = {"incl", "excl", "thread_incl"};
+        std::function<void(int,const std::string&)> writeNode;
+        writeNode = [&] (int i, const std::string& indent)
+        {
+            const auto pos = paths[i].rfind(pathsep);
+            const std::string name = (pos == std::string::npos) ? paths[i] : paths[i].substr(pos+1);
+            ofs << indent << "{\"name\": " << jsonString(name)
+                << ", \"ncalls\": " << vsum[4*i]/nprocs;
+            for (int k = 0; k < 3; ++k) {
+                auto x = stat(i,k);
+                ofs << ", \"" << statname[k] << "\": {\"min\": " << x[0]
+                    << ", \"avg\": " << x[1] << ", \"max\": " << x[2] << "}";
+            }
+            ofs << ",\n" << indent << " \"children\": [";
+            for (int j = 0; j < static_cast<int>(children[i].size()); ++j) {
+                ofs << (j == 0 ? "\n" : ",\n");
+                writeNode(children[i][j], indent + "  ");
+            }
+            ofs << "]}";
+        };
+
+        ofs << "{\"nprocs\": " << nprocs << ", \"nthreads\": " << nthreads << ",\n"
+            << " \"calltree\":\n";
+        auto root = index.find(mainregion);
+        if (root != index.end()) writeNode(root->second, "  ");
+        ofs << "\n}\n";
+    }
+}
+
 void
 TinyProfiler::StartRegion (std::string regname) noexcept
 {
@@ -419,8 +779,9 @@ void
 TinyProfiler::PrintCallStack (std::ostream& os)
 {
     os << "===== TinyProfilers ======\n";
-    for (auto const& x : ttstack) {
-        os << *(std::get<2>(x)) << "\n";
+    if (threaddata.empty()) return;
+    for (auto const& x : threaddata[0]->ttstack) {
+        os << *(x.fname) << "\n";
     }
 }
 
@@ -17,6 +17,8 @@
 #include <AMReX_NFiles.H>
 #include <AMReX_FPC.H>
 #include <AMReX_FabArrayUtility.H>
+#include <AMReX_VisMFCompressor.H>
+#include <AMReX_AsyncOut.H>
 
 namespace amrex {
 
@@ -37,6 +39,8 @@ bool VisMF::usePersistentIFStreams(false);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
 bool VisMF::allowSparseWrites(true);
+std::string VisMF::compressorName("shuffle_lz");
+Real VisMF::compressionTolerance(0.0);
 
 long VisMF::ioBufferSize(VisMF::IO_Buffer_Size);
 
@@ -86,6 +90,8 @@ VisMF::Initialize ()
     pp.query("usedynamicsetselection", useDynamicSetSelection);
     pp.query("iobuffersize", ioBufferSize);
     pp.query("allowsparsewrites", allowSparseWrites);
+    pp.query("compressor", compressorName);
+    pp.query("compression_tolerance", compressionTolerance);
 
     initialized = true;
 }
@@ -283,8 +289,9 @@ operator<< (std::ostream        &os,
 
     os << hd.m_fod      << '\n';
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(hd.m_vers == VisMF::Header::Version_v1           ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       os << hd.m_min      << '\n';
       os << hd.m_max      << '\n';
@@ -303,9 +310,10 @@ operator<< (std::ostream        &os,
       os << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
         os << FPC::NativeRealDescriptor() << '\n';
@@ -316,6 +324,18 @@ operator<< (std::ostream        &os,
       }
     }
 
+    if(hd.m_vers == VisMF::Header::Compressed_v1) {
+      BL_ASSERT(hd.m_compbytes.size() == hd.m_ba.size());
+      os << hd.m_compressor << ' ' << hd.m_compress_tol << '\n';
+      for(int i(0); i < hd.m_compbytes.size(); ++i) {
+        BL_ASSERT(hd.m_compbytes[i].size() == hd.m_ncomp);
+        for(int j(0); j < hd.m_compbytes[i].size(); ++j) {
+          os << hd.m_compbytes[i][j] << ' ';
+        }
+        os << '\n';
+      }
+    }
+
     os.flags(oflags);
     os.precision(oldPrec);
 
@@ -367,8 +387,9 @@ operator>> (std::istream  &is,
     is >> hd.m_fod;
     BL_ASSERT(hd.m_ba.size() == hd.m_fod.size());
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(hd.m_vers == VisMF::Header::Version_v1           ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       is >> hd.m_min;
       is >> hd.m_max;
@@ -393,12 +414,29 @@ operator>> (std::istream  &is,
 	}
       }
     }
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       is >> hd.m_writtenRD;
     }
+    if(hd.m_vers == VisMF::Header::Compressed_v1) {
+#ifdef BL_USE_FLOAT
+      double dtemp;
+      is >> hd.m_compressor >> dtemp;
+      hd.m_compress_tol = static_cast<Real>(dtemp);
+#else
+      is >> hd.m_compressor >> hd.m_compress_tol;
+#endif
+      hd.m_compbytes.resize(hd.m_ba.size());
+      for(int i(0); i < hd.m_compbytes.size(); ++i) {
+        hd.m_compbytes[i].resize(hd.m_ncomp);
+        for(int j(0); j < hd.m_ncomp; ++j) {
+          is >> hd.m_compbytes[i][j];
+        }
+      }
+    }
 
 
     if( ! is.good()) {
@@ -639,7 +677,8 @@ VisMF::Write (const FArrayBox&   fab,
 
 VisMF::Header::Header ()
     :
-    m_vers(VisMF::Header::Undefined_v1)
+    m_vers(VisMF::Header::Undefined_v1),
+    m_compress_tol(0.0)
 {}
 
 //
@@ -657,10 +696,17 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
     m_ncomp(mf.nComp()),
     m_ngrow(mf.nGrowVect()),
     m_ba(mf.boxArray()),
-    m_fod(m_ba.size())
+    m_fod(m_ba.size()),
+    m_compress_tol(0.0)
 {
 //    BL_PROFILE("VisMF::Header");
 
+    if(version == Compressed_v1) {
+      m_compressor   = VisMF::compressorName;
+      m_compress_tol = VisMF::compressionTolerance;
+      m_compbytes.resize(m_ba.size());
+    }
+
     if(version == NoFabHeader_v1) {
       m_min.clear();
       m_max.clear();
@@ -978,6 +1024,39 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
 
     bool oldHeader(currentVersion == VisMF::Header::Version_v1);
+    bool compressed(currentVersion == VisMF::Header::Compressed_v1);
+
+    // ---- compress everything before waiting for a turn to write
+    Vector<Vector<char> > compData;   // ---- [local fab * ncomp + comp]
+    if(compressed) {
+      BL_PROFILE("VisMF::Write:compress");
+      std::unique_ptr<VisMFCompressor> compressor =
+          VisMFCompressor::Create(hdr.m_compressor, hdr.m_compress_tol);
+      Vector<const FArrayBox *> localFabs;
+      Vector<int> localIndex;
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        localFabs.push_back(&mf[mfi]);
+        localIndex.push_back(mfi.index());
+      }
+      const int nComps(mf.nComp());
+      const int nItems(localFabs.size() * nComps);
+      compData.resize(nItems);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for(int i = 0; i < nItems; ++i) {
+        const FArrayBox &fab = *localFabs[i / nComps];
+        compressor->compress(fab.dataPtr(i % nComps), fab.box().numPts(), *whichRD, compData[i]);
+      }
+      for(int i(0); i < localFabs.size(); ++i) {
+        Vector<long> &cb = hdr.m_compbytes[localIndex[i]];
+        cb.resize(nComps);
+        for(int n(0); n < nComps; ++n) {
+          cb[n] = compData[i * nComps + n].size();
+          bytesWritten += cb[n];
+        }
+      }
+    }
 
       if(useSparseFPP) {
         nfi.SetSparseFPP(procsWithDataVector);
@@ -985,6 +1064,13 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         nfi.SetDynamic();
       }
       for( ; nfi.ReadyToWrite(); ++nfi) {
+          if(compressed) {
+            for(int i(0); i < compData.size(); ++i) {
+              nfi.Stream().write(compData[i].dataPtr(), compData[i].size());
+            }
+            nfi.Stream().flush();
+            continue;
+          }
 	  // ---- find the total number of bytes including fab headers if needed
           const FABio &fio = FArrayBox::getFABio();
           int whichRDBytes(whichRD->numBytes()), nFABs(0);
@@ -1073,8 +1159,9 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
       coordinatorProc = nfi.CoordinatorProc();
     }
 
-    if(currentVersion == VisMF::Header::Version_v1 ||
-       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(currentVersion == VisMF::Header::Version_v1           ||
+       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       currentVersion == VisMF::Header::Compressed_v1)
     {
       hdr.CalculateMinMax(mf, coordinatorProc);
     }
@@ -1223,6 +1310,54 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
       int whichRDBytes(whichRD->numBytes());
       int nComps(mf.nComp());
 
+#ifdef BL_USE_MPI
+      if(hdr.m_vers == VisMF::Header::Compressed_v1) {
+        // ---- only the writing rank knows the compressed sizes of a fab
+        Vector<int> nmtags(nProcs,0);
+        Vector<int> offset(nProcs,0);
+        const Vector<int> &pmap = mf.DistributionMap().ProcessorMap();
+        for(int i(0), N(mf.size()); i < N; ++i) {
+          nmtags[pmap[i]] += nComps;
+        }
+        for(int i(1), N(offset.size()); i < N; ++i) {
+          offset[i] = offset[i-1] + nmtags[i-1];
+        }
+
+        Vector<long> senddata(std::max(1, nmtags[myProc]));
+        int ioffset(0);
+        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+          for(int n(0); n < nComps; ++n) {
+            senddata[ioffset++] = hdr.m_compbytes[mfi.index()][n];
+          }
+        }
+        BL_ASSERT(ioffset == nmtags[myProc]);
+
+        Vector<long> recvdata(myProc == coordinatorProc ? std::max(1L, mf.size() * long(nComps)) : 1);
+
+        BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(),
+                                    nmtags[myProc],
+                                    ParallelDescriptor::Mpi_typemap<long>::type(),
+                                    recvdata.dataPtr(),
+                                    nmtags.dataPtr(),
+                                    offset.dataPtr(),
+                                    ParallelDescriptor::Mpi_typemap<long>::type(),
+                                    coordinatorProc,
+                                    comm) );
+
+        if(myProc == coordinatorProc) {
+          Vector<int> cnt(nProcs,0);
+          for(int j(0), N(mf.size()); j < N; ++j) {
+            const int i(pmap[j]);
+            hdr.m_compbytes[j].resize(nComps);
+            for(int n(0); n < nComps; ++n) {
+              hdr.m_compbytes[j][n] = recvdata[offset[i] + cnt[i] + n];
+            }
+            cnt[i] += nComps;
+          }
+        }
+      }
+#endif
+
       if(myProc == coordinatorProc) {   // ---- calculate offsets
 	const BoxArray &mfBA = mf.boxArray();
 	const DistributionMapping &mfDM = mf.DistributionMap();
@@ -1279,8 +1414,13 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 	      for(int i(0); i < index.size(); ++i) {
                  hdr.m_fod[index[i]].m_name = whichFileName;
                  hdr.m_fod[index[i]].m_head = currentOffset[whichFileNumber];
-                 currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
-	                                           + fabHeaderBytes[index[i]];
+                 if(hdr.m_vers == VisMF::Header::Compressed_v1) {
+                   const Vector<long> &cb = hdr.m_compbytes[index[i]];
+                   currentOffset[whichFileNumber] += std::accumulate(cb.begin(), cb.end(), 0L);
+                 } else {
+                   currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
+	                                             + fabHeaderBytes[index[i]];
+                 }
               }
             }
 	  }
@@ -1381,6 +1521,8 @@ VisMF::readFAB (int                  idx,
       } else {
         fab->readFrom(*infs, whichComp);
       }
+    } else if(hdr.m_vers == Header::Compressed_v1) {
+      VisMF::readCompressedFAB(*infs, *fab, idx, hdr, whichComp);
     } else {
       if(whichComp == -1) {    // ---- read all components
 	if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
@@ -1433,6 +1575,8 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
         RealDescriptor::convertToNativeFormat(fab.dataPtr(), readDataItems,
 	                                      *infs, hdr.m_writtenRD);
       }
+    } else if(hdr.m_vers == Header::Compressed_v1) {
+      VisMF::readCompressedFAB(*infs, fab, idx, hdr);
     } else {
       fab.readFrom(*infs);
     }
@@ -1441,6 +1585,41 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
 }
 
 
+void
+VisMF::readCompressedFAB (std::istream        &is,
+                          FArrayBox           &fab,
+                          int                  idx,
+                          const VisMF::Header &hdr,
+                          int                  whichComp)
+{
+    BL_ASSERT(hdr.m_vers == Header::Compressed_v1);
+    const Vector<long> &cb = hdr.m_compbytes[idx];
+    const long npts(fab.box().numPts());
+
+    std::unique_ptr<VisMFCompressor> compressor =
+        VisMFCompressor::Create(hdr.m_compressor, hdr.m_compress_tol);
+
+    int compLo(0), compHi(hdr.m_ncomp - 1);
+    if(whichComp >= 0) {
+      // ---- skip the components before the one we want
+      long skip(std::accumulate(cb.begin(), cb.begin() + whichComp, 0L));
+      is.seekg(skip, std::ios::cur);
+      compLo = compHi = whichComp;
+    }
+
+    Vector<char> buffer;
+    for(int n(compLo); n <= compHi; ++n) {
+      buffer.resize(cb[n]);
+      is.read(buffer.dataPtr(), cb[n]);
+      if( ! is.good()) {
+        amrex::Error("VisMF::readCompressedFAB: read failed");
+      }
+      compressor->decompress(buffer.dataPtr(), cb[n], fab.dataPtr(n - compLo), npts,
+                             hdr.m_writtenRD);
+    }
+}
+
+
 void
 VisMF::Read (FabArray<FArrayBox> &mf,
              const std::string   &mf_name,
@@ -2132,6 +2311,30 @@ void VisMF::CloseAllStreams() {
   VisMF::persistentIFStreams.clear();
 }
 
+void
+VisMF::WriteMaybeAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name,
+                        VisMF::How how, bool set_ghost)
+{
+    if (!AsyncOut::UseAsyncOut()) {
+        Write(mf, mf_name, how, set_ghost);
+        return;
+    }
+
+    const bool default_format = how == NFiles && currentVersion == VisMF::Header::Version_v1
+                                && !(set_ghost && mf.nGrow() > 0);
+    if (default_format) {
+        AsyncOut::Add(WriteAsync(mf, mf_name));
+    } else {
+        static bool warned = false;
+        if (!warned && ParallelDescriptor::IOProcessor()) {
+            amrex::Warning("VisMF: amrex.async_out only writes NFiles with Version_v1 headers;"
+                           " writing " + mf_name + " and the like synchronously");
+        }
+        warned = true;
+        Write(mf, mf_name, how, set_ghost);
+    }
+}
+
 std::future<WriteAsyncStatus>
 VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
 {
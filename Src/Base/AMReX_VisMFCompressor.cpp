@@ -0,0 +1,348 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+
+#include <AMReX_VisMFCompressor.H>
+#include <AMReX_FPC.H>
+#include <AMReX.H>
+
+namespace amrex {
+
+namespace {
+
+    //
+    // A byte oriented LZ77 coder in the style of LZ4.  The stream starts with
+    // the uncompressed size (8 bytes, little endian) followed by sequences of
+    //
+    //   token (literal length << 4 | (match length - 4)), extra literal length
+    //   bytes, literals, match offset (2 bytes), extra match length bytes
+    //
+    // where a nibble of 15 means more length bytes follow (255 means keep
+    // reading).  The last sequence has literals only.
+    //
+    constexpr int lz_min_match = 4;
+    constexpr int lz_hash_bits = 14;
+    constexpr long lz_max_offset = 65535;
+
+    inline std::uint32_t read32 (const unsigned char* p)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+
+    inline void put_length (Vector<char>& out, long len)
+    {
+        while (len >= 255) {
+            out.push_back(static_cast<char>(255));
+            len -= 255;
+        }
+        out.push_back(static_cast<char>(len));
+    }
+
+    void lz_compress (const unsigned char* src, long n, Vector<char>& out)
+    {
+        out.clear();
+        out.reserve(n/2 + 16);
+
+        std::uint64_t un = n;
+        for (int i = 0; i < 8; ++i) {
+            out.push_back(static_cast<char>((un >> (8*i)) & 0xff));
+        }
+
+        auto emit = [&] (long anchor, long nlit, long offset, long mlen)
+        {
+            const long ml = (mlen > 0) ? mlen - lz_min_match : 0;
+            const int tlit = static_cast<int>(std::min(nlit, 15L));
+            const int tml  = static_cast<int>(std::min(ml, 15L));
+            out.push_back(static_cast<char>((tlit << 4) | tml));
+            if (nlit >= 15) put_length(out, nlit-15);
+            out.insert(out.end(), reinterpret_cast<const char*>(src+anchor),
+                       reinterpret_cast<const char*>(src+anchor+nlit));
+            if (mlen > 0) {
+                out.push_back(static_cast<char>(offset & 0xff));
+                out.push_back(static_cast<char>((offset >> 8) & 0xff));
+                if (ml >= 15) put_length(out, ml-15);
+            }
+        };
+
+        std::vector<long> table(1 << lz_hash_bits, -1);
+        long anchor = 0;
+        long i = 0;
+        while (i + lz_min_match <= n)
+        {
+            const std::uint32_t v = read32(src+i);
+            const std::uint32_t h = (v * 2654435761u) >> (32 - lz_hash_bits);
+            const long cand = table[h];
+            table[h] = i;
+            if (cand >= 0 && i - cand <= lz_max_offset && read32(src+cand) == v)
+            {
+                long mlen = lz_min_match;
+                while (i + mlen < n && src[cand+mlen] == src[i+mlen]) {
+                    ++mlen;
+                }
+                emit(anchor, i-anchor, i-cand, mlen);
+                i += mlen;
+                anchor = i;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        emit(anchor, n-anchor, 0, 0);
+    }
+
+    void lz_decompress (const char* in, long nbytes, Vector<unsigned char>& out)
+    {
+        const unsigned char* ip = reinterpret_cast<const unsigned char*>(in);
+        const unsigned char* const iend = ip + nbytes;
+
+        if (nbytes < 8) amrex::Abort("VisMFCompressor: corrupt data");
+        std::uint64_t un = 0;
+        for (int i = 0; i < 8; ++i) {
+            un |= static_cast<std::uint64_t>(ip[i]) << (8*i);
+        }
+        ip += 8;
+        out.resize(un);
+        unsigned char* op = out.data();
+        unsigned char* const oend = op + un;
+
+        auto get_length = [&] (long len) -> long
+        {
+            if (len == 15) {
+                unsigned char b;
+                do {
+                    if (ip >= iend) amrex::Abort("VisMFCompressor: corrupt data");
+                    b = *ip++;
+                    len += b;
+                } while (b == 255);
+            }
+            return len;
+        };
+
+        while (ip < iend)
+        {
+            const unsigned char token = *ip++;
+            const long nlit = get_length(token >> 4);
+            if (nlit > iend-ip || nlit > oend-op) amrex::Abort("VisMFCompressor: corrupt data");
+            std::memcpy(op, ip, nlit);
+            ip += nlit;
+            op += nlit;
+            if (ip == iend) break;
+
+            if (iend-ip < 2) amrex::Abort("VisMFCompressor: corrupt data");
+            const long offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            const long mlen = get_length(token & 15) + lz_min_match;
+            if (offset == 0 || offset > op-out.data() || mlen > oend-op) {
+                amrex::Abort("VisMFCompressor: corrupt data");
+            }
+            // ---- the source and destination may overlap
+            const unsigned char* mp = op - offset;
+            for (long k = 0; k < mlen; ++k) {
+                op[k] = mp[k];
+            }
+            op += mlen;
+        }
+
+        if (op != oend) amrex::Abort("VisMFCompressor: corrupt data");
+    }
+
+    //
+    // Regroup the bytes of nwords words of wsize bytes so that byte b of
+    // every word is stored together.  Smooth data then have long runs in
+    // the high bytes.
+    //
+    void shuffle (const unsigned char* in, long nwords, int wsize, unsigned char* out)
+    {
+        for (int b = 0; b < wsize; ++b) {
+            for (long i = 0; i < nwords; ++i) {
+                out[b*nwords + i] = in[i*wsize + b];
+            }
+        }
+    }
+
+    void unshuffle (const unsigned char* in, long nwords, int wsize, unsigned char* out)
+    {
+        for (int b = 0; b < wsize; ++b) {
+            for (long i = 0; i < nwords; ++i) {
+                out[i*wsize + b] = in[b*nwords + i];
+            }
+        }
+    }
+
+    class ShuffleLZCompressor
+        : public VisMFCompressor
+    {
+    public:
+
+        virtual std::string name () const override { return "shuffle_lz"; }
+
+        virtual void compress (const Real* in, long nitems, const RealDescriptor& rd,
+                               Vector<char>& out) const override
+        {
+            const int wsize = rd.numBytes();
+            Vector<unsigned char> raw(nitems*wsize);
+            const unsigned char* src;
+            if (rd == FPC::NativeRealDescriptor()) {
+                src = reinterpret_cast<const unsigned char*>(in);
+            } else {
+                RealDescriptor::convertFromNativeFormat(raw.data(), nitems, in, rd);
+                src = raw.data();
+            }
+            Vector<unsigned char> shuffled(nitems*wsize);
+            shuffle(src, nitems, wsize, shuffled.data());
+            lz_compress(shuffled.data(), shuffled.size(), out);
+        }
+
+        virtual void decompress (const char* in, long nbytes, Real* out, long nitems,
+                                 const RealDescriptor& rd) const override
+        {
+            const int wsize = rd.numBytes();
+            Vector<unsigned char> shuffled;
+            lz_decompress(in, nbytes, shuffled);
+            if (static_cast<long>(shuffled.size()) != nitems*wsize) {
+                amrex::Abort("VisMFCompressor: unexpected size of shuffle_lz data");
+            }
+            if (rd == FPC::NativeRealDescriptor()) {
+                unshuffle(shuffled.data(), nitems, wsize, reinterpret_cast<unsigned char*>(out));
+            } else {
+                Vector<unsigned char> raw(nitems*wsize);
+                unshuffle(shuffled.data(), nitems, wsize, raw.data());
+                RealDescriptor::convertToNativeFormat(out, nitems, raw.data(), rd);
+            }
+        }
+    };
+
+    class QuantizeCompressor
+        : public VisMFCompressor
+    {
+    public:
+
+        explicit QuantizeCompressor (Real tolerance)
+            : m_tol(tolerance)
+        {
+            if (!(m_tol > 0.0)) {
+                amrex::Abort("VisMFCompressor: quantize needs vismf.compression_tolerance > 0");
+            }
+        }
+
+        virtual std::string name () const override { return "quantize"; }
+
+        virtual void compress (const Real* in, long nitems, const RealDescriptor& rd,
+                               Vector<char>& out) const override
+        {
+            const double step = 2.0*m_tol;
+            // ---- keep the quantized values well inside the exact range of doubles
+            const double qmax = 4503599627370496.0;  // 2^52
+
+            bool ok = true;
+            for (long i = 0; i < nitems && ok; ++i) {
+                const double q = in[i]/step;
+                ok = std::isfinite(q) && std::abs(q) < qmax;
+            }
+
+            if (!ok) {
+                m_lossless.compress(in, nitems, rd, out);
+                out.insert(out.begin(), static_cast<char>(lossless_flag));
+                return;
+            }
+
+            // ---- zigzag coded deltas of the quantized values as varints
+            Vector<unsigned char> deltas;
+            deltas.reserve(nitems);
+            std::int64_t qprev = 0;
+            for (long i = 0; i < nitems; ++i) {
+                const std::int64_t q = std::llround(in[i]/step);
+                const std::int64_t d = q - qprev;
+                qprev = q;
+                std::uint64_t z = (static_cast<std::uint64_t>(d) << 1) ^
+                                  static_cast<std::uint64_t>(d >> 63);
+                while (z >= 0x80) {
+                    deltas.push_back(static_cast<unsigned char>(z | 0x80));
+                    z >>= 7;
+                }
+                deltas.push_back(static_cast<unsigned char>(z));
+            }
+
+            lz_compress(deltas.data(), deltas.size(), out);
+            out.insert(out.begin(), static_cast<char>(quantized_flag));
+        }
+
+        virtual void decompress (const char* in, long nbytes, Real* out, long nitems,
+                                 const RealDescriptor& rd) const override
+        {
+            if (nbytes < 1) amrex::Abort("VisMFCompressor: corrupt data");
+
+            if (in[0] == lossless_flag) {
+                m_lossless.decompress(in+1, nbytes-1, out, nitems, rd);
+                return;
+            }
+
+            Vector<unsigned char> deltas;
+            lz_decompress(in+1, nbytes-1, deltas);
+
+            const double step = 2.0*m_tol;
+            const unsigned char* p = deltas.data();
+            const unsigned char* const pend = p + deltas.size();
+            std::int64_t q = 0;
+            for (long i = 0; i < nitems; ++i) {
+                std::uint64_t z = 0;
+                int shift = 0;
+                unsigned char b;
+                do {
+                    if (p == pend) amrex::Abort("VisMFCompressor: corrupt data");
+                    b = *p++;
+                    z |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+                    shift += 7;
+                } while (b & 0x80);
+                const std::int64_t d = static_cast<std::int64_t>(z >> 1) ^
+                                       -static_cast<std::int64_t>(z & 1);
+                q += d;
+                out[i] = static_cast<Real>(q*step);
+            }
+        }
+
+    private:
+
+        static constexpr char quantized_flag = 0;
+        static constexpr char lossless_flag = 1;
+
+        Real m_tol;
+        ShuffleLZCompressor m_lossless;
+    };
+
+    constexpr char QuantizeCompressor::quantized_flag;
+    constexpr char QuantizeCompressor::lossless_flag;
+
+    std::map<std::string, VisMFCompressor::Maker>& registry ()
+    {
+        static std::map<std::string, VisMFCompressor::Maker> r {
+            {"shuffle_lz", [] (Real) -> std::unique_ptr<VisMFCompressor>
+                           { return std::unique_ptr<VisMFCompressor>(new ShuffleLZCompressor()); }},
+            {"quantize",   [] (Real tol) -> std::unique_ptr<VisMFCompressor>
+                           { return std::unique_ptr<VisMFCompressor>(new QuantizeCompressor(tol)); }}
+        };
+        return r;
+    }
+}
+
+std::unique_ptr<VisMFCompressor>
+VisMFCompressor::Create (const std::string& name, Real tolerance)
+{
+    auto it = registry().find(name);
+    if (it == registry().end()) {
+        amrex::Abort("VisMFCompressor::Create: unknown compressor " + name);
+    }
+    return it->second(tolerance);
+}
+
+void
+VisMFCompressor::Register (const std::string& name, Maker maker)
+{
+    registry()[name] = std::move(maker);
+}
+
+}
@@ -12,17 +12,27 @@
 #include <AMReX_ParmParse.H>
 #include <AMReX.H>
 #include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
 Vector<std::unique_ptr<IndexSpace> > IndexSpace::m_instance;
 
 int max_grid_size = 64;
+bool compress_geometry = false;
+std::string chkpt_file;
+std::string chkpt_key;
 
 void Initialize ()
 {
     ParmParse pp("eb2");
     pp.query("max_grid_size", max_grid_size);
+    pp.query("compress_geometry", compress_geometry);
+    pp.query("chkpt_file", chkpt_file);
+    pp.query("chkpt_key", chkpt_key);
 
     amrex::ExecOnFinalize(Finalize);
 }
@@ -56,6 +66,96 @@ IndexSpace::erase (IndexSpace* ispace)
     }
 }
 
+namespace {
+    const std::string chkpt_magic = "EB2::IndexSpace checkpoint";
+}
+
+IndexSpaceChkpt::IndexSpaceChkpt (const std::string& dirname, const Geometry& geom)
+{
+    BL_PROFILE("EB2::IndexSpaceChkpt()");
+
+    int nlevels;
+    {
+        Vector<char> buf;
+        ParallelDescriptor::ReadAndBcastFile(dirname+"/Header", buf);
+        std::istringstream iss(buf.dataPtr(), std::istringstream::in);
+        std::string magic, key;
+        std::getline(iss, magic);
+        std::getline(iss, key);
+        iss >> nlevels;
+    }
+
+    m_chklevel.reserve(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev)
+    {
+        m_geom.push_back((ilev == 0) ? geom : amrex::coarsen(m_geom.back(),2));
+        m_domain.push_back(m_geom.back().Domain());
+        m_chklevel.emplace_back(this, m_geom.back(), amrex::LevelFullPath(ilev, dirname));
+        if (compress_geometry) m_chklevel.back().compress();
+    }
+}
+
+const Level&
+IndexSpaceChkpt::getLevel (const Geometry& geom) const
+{
+    auto it = std::find(std::begin(m_domain), std::end(m_domain), geom.Domain());
+    int i = std::distance(m_domain.begin(), it);
+    return m_chklevel[i];
+}
+
+const Geometry&
+IndexSpaceChkpt::getGeometry (const Box& dom) const
+{
+    auto it = std::find(std::begin(m_domain), std::end(m_domain), dom);
+    int i = std::distance(m_domain.begin(), it);
+    return m_geom[i];
+}
+
+bool
+IndexSpaceChkpt::isValid (const std::string& dirname, const std::string& key)
+{
+    const std::string& hname = dirname + "/Header";
+    int valid = 0;
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::ifstream ifs(hname.c_str());
+        std::string magic, fkey;
+        if (ifs.good() && std::getline(ifs, magic) && std::getline(ifs, fkey)) {
+            valid = (magic == chkpt_magic && fkey == key);
+        }
+    }
+    ParallelDescriptor::Bcast(&valid, 1, ParallelDescriptor::IOProcessorNumber());
+    return valid;
+}
+
+void
+IndexSpaceChkpt::writeHeader (const std::string& dirname, const std::string& key, int nlevels)
+{
+    ParallelDescriptor::Barrier();
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const std::string& hname = dirname + "/Header";
+        std::ofstream ofs(hname.c_str(), std::ios::out|std::ios::trunc);
+        if (!ofs.good()) amrex::FileOpenFailed(hname);
+        ofs << chkpt_magic << "\n" << key << "\n" << nlevels << "\n";
+        ofs.close();
+        if (!ofs.good()) amrex::Abort("EB2::IndexSpaceChkpt: failed to write "+hname);
+    }
+}
+
+std::string
+hashString (const std::string& s)
+{
+    std::uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << h;
+    return os.str();
+}
+
 const IndexSpace* TopIndexSpaceIfPresent() noexcept {
     if (IndexSpace::size() > 0) {
         return &IndexSpace::top();
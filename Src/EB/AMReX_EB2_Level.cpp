@@ -1,10 +1,49 @@
 
 #include <AMReX_EB2_Level.H>
 #include <AMReX_IArrayBox.H>
+#include <AMReX_Utility.H>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
+namespace {
+    // Components of the cell data of a compressed level
+    constexpr int vfrac_comp     = 0;
+    constexpr int centroid_comp  = 1;
+    constexpr int bndryarea_comp = AMREX_SPACEDIM+1;
+    constexpr int bndrycent_comp = AMREX_SPACEDIM+2;
+    constexpr int bndrynorm_comp = 2*AMREX_SPACEDIM+2;
+    constexpr int ncellcomp      = 3*AMREX_SPACEDIM+2;
+    // and of the face data: area fraction followed by face centroid
+    constexpr int areafrac_comp  = 0;
+    constexpr int facecent_comp  = 1;
+    constexpr int nfacecomp      = AMREX_SPACEDIM;
+
+    // Data of a regular or a covered cell, as set by build_cells
+    Real cell_default (EBCellFlag flag, int n) noexcept
+    {
+        if (n == vfrac_comp) {
+            return flag.isCovered() ? 0.0 : 1.0;
+        } else if (n >= bndrycent_comp && n < bndrynorm_comp) {
+            return -1.0;
+        } else {
+            return 0.0;
+        }
+    }
+
+    // Data of a face between two cells that are not cut
+    Real face_default (EBCellFlag flag_lo, EBCellFlag flag_hi, int n) noexcept
+    {
+        if (n == areafrac_comp) {
+            return (flag_lo.isCovered() || flag_hi.isCovered()) ? 0.0 : 1.0;
+        } else {
+            return 0.0;
+        }
+    }
+}
+
 void
 Level::prepareForCoarsening (const Level& rhs, int max_grid_size, IntVect ngrow)
 {
@@ -188,15 +227,13 @@ Level::coarsenFromFine (Level& fineLevel, bool fill_boundary)
         const Geometry& fine_geom = fineLevel.m_geom;
         const auto& fine_period = fine_geom.periodicity();
         f_cellflag.FillBoundary(fine_period);
-        f_volfrac.FillBoundary(fine_period);
-        f_centroid.FillBoundary(fine_period);
-        f_bndryarea.FillBoundary(fine_period);
-        f_bndrycent.FillBoundary(fine_period);
-        f_bndrynorm.FillBoundary(fine_period);
+        Vector<FabArray<FArrayBox>*> f_mfs {&f_volfrac, &f_centroid, &f_bndryarea,
+                                            &f_bndrycent, &f_bndrynorm};
         for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-            f_areafrac[idim].FillBoundary(fine_period);
-            f_facecent[idim].FillBoundary(fine_period);
+            f_mfs.push_back(&f_areafrac[idim]);
+            f_mfs.push_back(&f_facecent[idim]);
         }
+        amrex::FillBoundary(f_mfs, fine_period);
 
         if (!fine_covered_grids.empty())
         {
@@ -417,6 +454,312 @@ Level::buildCellFlag ()
     }
 }
 
+void
+Level::compress ()
+{
+    if (m_allregular || m_compressed) return;
+
+    BL_PROFILE("EB2::Level::compress()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(Gpu::notInLaunchRegion(),
+                                     "EB2::Level::compress: not supported on GPU");
+
+    m_cutcells.define(m_grids, m_dmap);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(m_cutcells); mfi.isValid(); ++mfi)
+    {
+        CutCellData& cc = m_cutcells[mfi];
+        const Box& bx = mfi.validbox();
+        auto const& flag = m_cellflag.const_array(mfi);
+        auto const& vfr = m_volfrac.const_array(mfi);
+        auto const& ctr = m_centroid.const_array(mfi);
+        auto const& bar = m_bndryarea.const_array(mfi);
+        auto const& bct = m_bndrycent.const_array(mfi);
+        auto const& bnm = m_bndrynorm.const_array(mfi);
+
+        Real v[ncellcomp];
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+        {
+            v[vfrac_comp] = vfr(i,j,k);
+            v[bndryarea_comp] = bar(i,j,k);
+            for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+                v[centroid_comp+n] = ctr(i,j,k,n);
+                v[bndrycent_comp+n] = bct(i,j,k,n);
+                v[bndrynorm_comp+n] = bnm(i,j,k,n);
+            }
+            bool keep = false;
+            for (int n = 0; n < ncellcomp; ++n) {
+                keep = keep || (v[n] != cell_default(flag(i,j,k), n));
+            }
+            if (keep) {
+                cc.cells.push_back(bx.index(IntVect(AMREX_D_DECL(i,j,k))));
+                cc.cell_data.insert(cc.cell_data.end(), v, v+ncellcomp);
+            }
+        });
+
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            const Box& fbx = amrex::surroundingNodes(bx,idim);
+            const IntVect shift = IntVect::TheDimensionVector(idim);
+            auto const& apf = m_areafrac[idim].const_array(mfi);
+            auto const& fcf = m_facecent[idim].const_array(mfi);
+            auto& faces = cc.faces[idim];
+            auto& face_data = cc.face_data[idim];
+
+            Real f[nfacecomp];
+            amrex::LoopOnCpu(fbx, [&] (int i, int j, int k) noexcept
+            {
+                const IntVect iv(AMREX_D_DECL(i,j,k));
+                f[areafrac_comp] = apf(iv);
+                for (int n = 0; n < AMREX_SPACEDIM-1; ++n) {
+                    f[facecent_comp+n] = fcf(iv,n);
+                }
+                bool keep = false;
+                for (int n = 0; n < nfacecomp; ++n) {
+                    keep = keep || (f[n] != face_default(flag(iv-shift), flag(iv), n));
+                }
+                if (keep) {
+                    faces.push_back(fbx.index(iv));
+                    face_data.insert(face_data.end(), f, f+nfacecomp);
+                }
+            });
+        }
+    }
+
+    m_volfrac.clear();
+    m_centroid.clear();
+    m_bndryarea.clear();
+    m_bndrycent.clear();
+    m_bndrynorm.clear();
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        m_areafrac[idim].clear();
+        m_facecent[idim].clear();
+    }
+
+    m_compressed = true;
+}
+
+const MultiFab&
+Level::cellData (const MultiFab& dense, int icomp, int ncomp, MultiFab& tmp) const
+{
+    if (!m_compressed) return dense;
+
+    tmp.define(m_grids, m_dmap, ncomp, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(tmp); mfi.isValid(); ++mfi)
+    {
+        const CutCellData& cc = m_cutcells[mfi];
+        const Box& bx = mfi.validbox();
+        auto const& a = tmp.array(mfi);
+        auto const& flag = m_cellflag.const_array(mfi);
+
+        amrex::LoopConcurrentOnCpu(bx, ncomp, [=] (int i, int j, int k, int n) noexcept
+        {
+            a(i,j,k,n) = cell_default(flag(i,j,k), icomp+n);
+        });
+
+        const int ncells = cc.cells.size();
+        for (int m = 0; m < ncells; ++m) {
+            const IntVect& iv = bx.atOffset(cc.cells[m]);
+            for (int n = 0; n < ncomp; ++n) {
+                a(iv,n) = cc.cell_data[m*ncellcomp+icomp+n];
+            }
+        }
+    }
+
+    return tmp;
+}
+
+const MultiFab&
+Level::faceData (const MultiFab& dense, int idim, int icomp, int ncomp, MultiFab& tmp) const
+{
+    if (!m_compressed) return dense;
+
+    tmp.define(amrex::convert(m_grids, IntVect::TheDimensionVector(idim)), m_dmap, ncomp, 0);
+    const IntVect shift = IntVect::TheDimensionVector(idim);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(tmp); mfi.isValid(); ++mfi)
+    {
+        const auto& faces = m_cutcells[mfi].faces[idim];
+        const auto& face_data = m_cutcells[mfi].face_data[idim];
+        const Box& fbx = mfi.validbox();
+        auto const& a = tmp.array(mfi);
+        auto const& flag = m_cellflag.const_array(mfi);
+
+        amrex::LoopConcurrentOnCpu(fbx, ncomp, [=] (int i, int j, int k, int n) noexcept
+        {
+            const IntVect iv(AMREX_D_DECL(i,j,k));
+            a(iv,n) = face_default(flag(iv-shift), flag(iv), icomp+n);
+        });
+
+        const int nfaces = faces.size();
+        for (int m = 0; m < nfaces; ++m) {
+            const IntVect& iv = fbx.atOffset(faces[m]);
+            for (int n = 0; n < ncomp; ++n) {
+                a(iv,n) = face_data[m*nfacecomp+icomp+n];
+            }
+        }
+    }
+
+    return tmp;
+}
+
+namespace {
+    // Write the valid region of the first ncomp components of mf
+    void writeValid (const MultiFab& mf, int ncomp, const std::string& name)
+    {
+        MultiFab v(mf.boxArray(), mf.DistributionMap(), ncomp, 0);
+        MultiFab::Copy(v, mf, 0, 0, ncomp, 0);
+        VisMF::Write(v, name);
+    }
+
+    // Read what writeValid wrote into mf on our boxes
+    void readValid (MultiFab& mf, const BoxArray& ba, const DistributionMapping& dm,
+                    int ncomp, const std::string& name)
+    {
+        mf.define(ba, dm, ncomp, 0);
+        VisMF::Read(mf, name);
+    }
+}
+
+void
+Level::writeToChkptFile (const std::string& dirname) const
+{
+    BL_PROFILE("EB2::Level::writeToChkptFile()");
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const std::string& hname = dirname + "/Header";
+        VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
+        std::ofstream ofs;
+        ofs.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+        ofs.open(hname.c_str(), std::ios::out|std::ios::trunc);
+        if (!ofs.good()) amrex::FileOpenFailed(hname);
+        ofs << m_allregular << "\n" << m_ngrow << "\n";
+        if (!m_allregular) {
+            m_grids.writeOn(ofs);
+            ofs << "\n" << m_covered_grids.size() << "\n";
+            if (!m_covered_grids.empty()) {
+                m_covered_grids.writeOn(ofs);
+                ofs << "\n";
+            }
+        }
+        ofs.close();
+        if (!ofs.good()) amrex::Abort("EB2::Level::writeToChkptFile: failed to write "+hname);
+    }
+
+    if (m_allregular) return;
+
+    {
+        MultiFab flag(m_grids, m_dmap, 1, 0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(flag); mfi.isValid(); ++mfi)
+        {
+            auto const& f = flag.array(mfi);
+            auto const& cf = m_cellflag.const_array(mfi);
+            amrex::LoopConcurrentOnCpu(mfi.validbox(), [=] (int i, int j, int k) noexcept
+            {
+                f(i,j,k) = static_cast<Real>(cf(i,j,k).getValue());
+            });
+        }
+        VisMF::Write(flag, dirname+"/CellFlag");
+    }
+
+    MultiFab tmp;
+    writeValid(cellData(m_volfrac, vfrac_comp, 1, tmp), 1, dirname+"/VolFrac");
+    writeValid(cellData(m_centroid, centroid_comp, AMREX_SPACEDIM, tmp), AMREX_SPACEDIM,
+               dirname+"/Centroid");
+    writeValid(cellData(m_bndryarea, bndryarea_comp, 1, tmp), 1, dirname+"/BndryArea");
+    writeValid(cellData(m_bndrycent, bndrycent_comp, AMREX_SPACEDIM, tmp), AMREX_SPACEDIM,
+               dirname+"/BndryCent");
+    writeValid(cellData(m_bndrynorm, bndrynorm_comp, AMREX_SPACEDIM, tmp), AMREX_SPACEDIM,
+               dirname+"/BndryNorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        const std::string& d = std::to_string(idim);
+        writeValid(faceData(m_areafrac[idim], idim, areafrac_comp, 1, tmp), 1,
+                   dirname+"/AreaFrac_"+d);
+        writeValid(faceData(m_facecent[idim], idim, facecent_comp, AMREX_SPACEDIM-1, tmp),
+                   AMREX_SPACEDIM-1, dirname+"/FaceCent_"+d);
+    }
+    writeValid(m_levelset, 1, dirname+"/LevelSet");
+}
+
+ChkptLevel::ChkptLevel (IndexSpace const* is, const Geometry& geom, const std::string& dirname)
+    : Level(is, geom)
+{
+    BL_PROFILE("EB2::ChkptLevel()");
+
+    {
+        Vector<char> buf;
+        ParallelDescriptor::ReadAndBcastFile(dirname+"/Header", buf);
+        std::istringstream iss(buf.dataPtr(), std::istringstream::in);
+        iss >> m_allregular >> m_ngrow;
+        if (!m_allregular) {
+            m_grids.readFrom(iss);
+            int ncovered;
+            iss >> ncovered;
+            if (ncovered > 0) m_covered_grids.readFrom(iss);
+        }
+    }
+
+    if (m_allregular) {
+        m_ok = true;
+        return;
+    }
+
+    m_dmap = DistributionMapping(m_grids);
+
+    const int ng = 2;
+
+    {
+        MultiFab flag;
+        readValid(flag, m_grids, m_dmap, 1, dirname+"/CellFlag");
+        m_cellflag.define(m_grids, m_dmap, 1, ng);
+        m_cellflag.setVal(EBCellFlag::TheCoveredCell());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(flag); mfi.isValid(); ++mfi)
+        {
+            auto const& f = flag.const_array(mfi);
+            auto const& cf = m_cellflag.array(mfi);
+            amrex::LoopConcurrentOnCpu(mfi.validbox(), [=] (int i, int j, int k) noexcept
+            {
+                cf(i,j,k) = static_cast<uint32_t>(f(i,j,k));
+            });
+        }
+        m_cellflag.FillBoundary(m_geom.periodicity());
+    }
+
+    // Only the valid regions of the geometric data are used once a level is built.
+    readValid(m_volfrac, m_grids, m_dmap, 1, dirname+"/VolFrac");
+    readValid(m_centroid, m_grids, m_dmap, AMREX_SPACEDIM, dirname+"/Centroid");
+    readValid(m_bndryarea, m_grids, m_dmap, 1, dirname+"/BndryArea");
+    readValid(m_bndrycent, m_grids, m_dmap, AMREX_SPACEDIM, dirname+"/BndryCent");
+    readValid(m_bndrynorm, m_grids, m_dmap, AMREX_SPACEDIM, dirname+"/BndryNorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        const BoxArray& fba = amrex::convert(m_grids, IntVect::TheDimensionVector(idim));
+        const std::string& d = std::to_string(idim);
+        readValid(m_areafrac[idim], fba, m_dmap, 1, dirname+"/AreaFrac_"+d);
+        readValid(m_facecent[idim], fba, m_dmap, AMREX_SPACEDIM-1, dirname+"/FaceCent_"+d);
+    }
+    readValid(m_levelset, amrex::convert(m_grids, IntVect::TheNodeVector()), m_dmap, 1,
+              dirname+"/LevelSet");
+
+    m_ok = true;
+}
+
 void
 Level::fillEBCellFlag (FabArray<EBCellFlagFab>& cellflag, const Geometry& geom) const
 {
@@ -480,7 +823,9 @@ Level::fillVolFrac (MultiFab& vfrac, const Geometry& geom) const
     vfrac.setVal(1.0);
     if (isAllRegular()) return;
 
-    vfrac.ParallelCopy(m_volfrac,0,0,1,0,vfrac.nGrow(),geom.periodicity());
+    MultiFab tmp;
+    vfrac.ParallelCopy(cellData(m_volfrac, vfrac_comp, 1, tmp),
+                       0,0,1,0,vfrac.nGrow(),geom.periodicity());
 
     const std::vector<IntVect>& pshifts = geom.periodicity().shiftIntVect();
 
@@ -550,8 +895,9 @@ Level::fillCentroid (MultiFab& centroid, const Geometry& geom) const
 {
     centroid.setVal(0.0);
     if (!isAllRegular()) {
-        centroid.ParallelCopy(m_centroid,0,0,AMREX_SPACEDIM,0,centroid.nGrow(),
-                              geom.periodicity());
+        MultiFab tmp;
+        centroid.ParallelCopy(cellData(m_centroid, centroid_comp, AMREX_SPACEDIM, tmp),
+                              0,0,AMREX_SPACEDIM,0,centroid.nGrow(),geom.periodicity());
     }
 }
 
@@ -574,7 +920,9 @@ Level::fillBndryArea (   MultiFab& bndryarea, const Geometry& geom) const
 {
     bndryarea.setVal(0.0);
     if (!isAllRegular()) {
-        bndryarea.ParallelCopy(m_bndryarea,0,0,1,0,bndryarea.nGrow(),geom.periodicity());
+        MultiFab tmp;
+        bndryarea.ParallelCopy(cellData(m_bndryarea, bndryarea_comp, 1, tmp),
+                               0,0,1,0,bndryarea.nGrow(),geom.periodicity());
     }
 }
        
@@ -597,8 +945,9 @@ Level::fillBndryCent (MultiFab& bndrycent, const Geometry& geom) const
 {
     bndrycent.setVal(-1.0);
     if (!isAllRegular()) {
-        bndrycent.ParallelCopy(m_bndrycent,0,0,bndrycent.nComp(),0,bndrycent.nGrow(),
-                               geom.periodicity());
+        MultiFab tmp;
+        bndrycent.ParallelCopy(cellData(m_bndrycent, bndrycent_comp, AMREX_SPACEDIM, tmp),
+                               0,0,bndrycent.nComp(),0,bndrycent.nGrow(),geom.periodicity());
     }
 }
 
@@ -621,8 +970,9 @@ Level::fillBndryNorm (   MultiFab& bndrynorm, const Geometry& geom) const
 {
     bndrynorm.setVal(0.0);
     if (!isAllRegular()) {
-        bndrynorm.ParallelCopy(m_bndrynorm,0,0,bndrynorm.nComp(),0,bndrynorm.nGrow(),
-                               geom.periodicity());
+        MultiFab tmp;
+        bndrynorm.ParallelCopy(cellData(m_bndrynorm, bndrynorm_comp, AMREX_SPACEDIM, tmp),
+                               0,0,bndrynorm.nComp(),0,bndrynorm.nGrow(),geom.periodicity());
     }
 }
         
@@ -642,8 +992,9 @@ Level::fillAreaFrac (Array<MultiCutFab*,AMREX_SPACEDIM> const& a_areafrac, const
         MultiFab tmp(areafrac.boxArray(), areafrac.DistributionMap(),
                      areafrac.nComp(), areafrac.nGrow());
         tmp.setVal(1.0);
-        tmp.ParallelCopy(m_areafrac[idim],0,0,areafrac.nComp(),
-                         0,areafrac.nGrow(),geom.periodicity());
+        MultiFab tmp_ap;
+        tmp.ParallelCopy(faceData(m_areafrac[idim], idim, areafrac_comp, 1, tmp_ap),
+                         0,0,areafrac.nComp(),0,areafrac.nGrow(),geom.periodicity());
         copyMultiFabToMultiCutFab(areafrac, tmp);
     }
 
@@ -715,8 +1066,9 @@ Level::fillAreaFrac (Array<MultiFab*,AMREX_SPACEDIM> const& a_areafrac, const Ge
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
     {
         auto& areafrac = *a_areafrac[idim];
-        areafrac.ParallelCopy(m_areafrac[idim],0,0,areafrac.nComp(),
-                              0,areafrac.nGrow(),geom.periodicity());
+        MultiFab tmp;
+        areafrac.ParallelCopy(faceData(m_areafrac[idim], idim, areafrac_comp, 1, tmp),
+                              0,0,areafrac.nComp(),0,areafrac.nGrow(),geom.periodicity());
     }
 
     const std::vector<IntVect>& pshifts = geom.periodicity().shiftIntVect();
@@ -788,8 +1140,9 @@ Level::fillFaceCent (Array<MultiCutFab*,AMREX_SPACEDIM> const& a_facecent, const
         MultiFab tmp(facecent.boxArray(), facecent.DistributionMap(),
                      facecent.nComp(), facecent.nGrow());
         tmp.setVal(0.0);
-        tmp.ParallelCopy(m_facecent[idim],0,0,facecent.nComp(),
-                         0,facecent.nGrow(),geom.periodicity());
+        MultiFab tmp_fc;
+        tmp.ParallelCopy(faceData(m_facecent[idim], idim, facecent_comp, AMREX_SPACEDIM-1, tmp_fc),
+                         0,0,facecent.nComp(),0,facecent.nGrow(),geom.periodicity());
         copyMultiFabToMultiCutFab(facecent,tmp);
     }
 }
@@ -804,8 +1157,10 @@ Level::fillFaceCent (Array<MultiFab*,AMREX_SPACEDIM> const& a_facecent, const Ge
         for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
         {
             auto& facecent = *a_facecent[idim];
-            a_facecent[idim]->ParallelCopy(m_facecent[idim],0,0,facecent.nComp(),
-                                           0,facecent.nGrow(),geom.periodicity());
+            MultiFab tmp;
+            facecent.ParallelCopy(faceData(m_facecent[idim], idim, facecent_comp,
+                                           AMREX_SPACEDIM-1, tmp),
+                                  0,0,facecent.nComp(),0,facecent.nGrow(),geom.periodicity());
         }
     }
 }
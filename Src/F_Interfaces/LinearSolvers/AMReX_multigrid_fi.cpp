@@ -86,6 +86,12 @@
              mlmg->setBottomSolver(MLMG::BottomSolver::hypre);
          } else if (s == 4) {
              mlmg->setBottomSolver(MLMG::BottomSolver::petsc);
+         } else if (s == 5) {
+             mlmg->setBottomSolver(MLMG::BottomSolver::pipebicgstab);
+         } else if (s == 6) {
+             mlmg->setBottomSolver(MLMG::BottomSolver::pipecg);
+         } else if (s == 7) {
+             mlmg->setBottomSolver(MLMG::BottomSolver::sstepcg);
          } else {
              amrex::Abort("amrex_fi_multigrid_set_bottom_solver: unknown bottom solver");
          }
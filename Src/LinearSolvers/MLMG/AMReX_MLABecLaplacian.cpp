@@ -237,6 +237,13 @@ MLABecLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& i
                      const auto& byfab = bycoef.array(mfi);,
                      const auto& bzfab = bzcoef.array(mfi););
 
+#if (AMREX_SPACEDIM == 3) && (__cplusplus >= 201402L)
+        if (Gpu::notInLaunchRegion()) {
+            mlabeclap_adotx_simd(bx, yfab, xfab, afab, bxfab, byfab, bzfab,
+                                 dxinv, ascalar, bscalar, ncomp);
+            continue;
+        }
+#endif
         AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( bx, tbx,
         {
             mlabeclap_adotx(tbx, yfab, xfab, afab, AMREX_D_DECL(bxfab,byfab,bzfab),
@@ -365,6 +372,16 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
 #endif
 #endif
 
+#if (AMREX_SPACEDIM == 3) && (__cplusplus >= 201402L)
+        if (Gpu::notInLaunchRegion()) {
+            abec_gsrb_simd(tbx, solnfab, rhsfab, alpha, afab,
+                           dhx, dhy, dhz, bxfab, byfab, bzfab,
+                           m0, m2, m4, m1, m3, m5,
+                           f0fab, f2fab, f4fab, f1fab, f3fab, f5fab,
+                           vbx, redblack, nc);
+            continue;
+        }
+#endif
         AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( tbx, thread_box,
         {
             abec_gsrb(thread_box, solnfab, rhsfab, alpha, afab,
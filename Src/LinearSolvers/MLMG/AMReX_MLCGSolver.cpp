@@ -11,6 +11,7 @@
 #include <AMReX_VisMF.H>
 #include <AMReX_ParallelReduce.H>
 #include <AMReX_MLMG.H>
+#include <AMReX_MultiFabExpr.H>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -48,6 +49,65 @@ sxay (MultiFab&       ss,
     sxay(ss,xx,a,yy,0,nghost);
 }
 
+//
+// Solve the s x s system A X = B of an s-step Gram matrix, A = P^T M P,
+// with nrhs right-hand sides stored column-wise in B (B[i+j*s]).  The
+// matrix is diagonally scaled and factored by LU without pivoting, which
+// is safe because its symmetric part is positive definite for the
+// (nearly symmetric) MLMG operators.  If A is numerically singular, which
+// happens when the Krylov space is exhausted before s vectors, only its
+// leading block of full rank is used and the remaining unknowns are set
+// to zero.  Returns the rank used.
+//
+int
+gram_solve (Vector<Real> A, int s, Real* B, int nrhs)
+{
+    constexpr Real pivot_tol = 1.e-12;
+    int rank = s;
+    Vector<Real> d(s, 0.0);
+    for (int i = 0; i < s; ++i) {
+        if (A[i+i*s] <= 0.0) {
+            rank = i;
+            break;
+        }
+        d[i] = 1.0/std::sqrt(A[i+i*s]);
+    }
+    for (int j = 0; j < rank; ++j) {
+        for (int i = 0; i < rank; ++i) {
+            A[i+j*s] *= d[i]*d[j];
+        }
+    }
+    // A = L U with unit lower L, both stored in A
+    for (int k = 0; k < rank; ++k) {
+        if (A[k+k*s] <= pivot_tol) {
+            rank = k;
+            break;
+        }
+        for (int i = k+1; i < rank; ++i) {
+            A[i+k*s] /= A[k+k*s];
+        }
+        for (int j = k+1; j < rank; ++j) {
+            for (int i = k+1; i < rank; ++i) {
+                A[i+j*s] -= A[i+k*s]*A[k+j*s];
+            }
+        }
+    }
+    for (int r = 0; r < nrhs; ++r) {
+        Real* b = B + r*s;
+        for (int i = 0; i < rank; ++i) b[i] *= d[i];
+        for (int i = 0; i < rank; ++i) {
+            for (int k = 0; k < i; ++k) b[i] -= A[i+k*s]*b[k];
+        }
+        for (int i = rank-1; i >= 0; --i) {
+            for (int k = i+1; k < rank; ++k) b[i] -= A[i+k*s]*b[k];
+            b[i] /= A[i+i*s];
+        }
+        for (int i = 0; i < rank; ++i) b[i] *= d[i];
+        for (int i = rank; i < s; ++i) b[i] = 0.0;
+    }
+    return rank;
+}
+
 }
 
 MLCGSolver::MLCGSolver (MLMG* a_mlmg, MLLinOp& _lp, Type _typ)
@@ -69,9 +129,16 @@ MLCGSolver::solve (MultiFab&       sol,
                    Real            eps_rel,
                    Real            eps_abs)
 {
-    if (solver_type == Type::BiCGStab) {
+    switch (solver_type) {
+    case Type::BiCGStab:
         return solve_bicgstab(sol,rhs,eps_rel,eps_abs);
-    } else {
+    case Type::PipeBiCGStab:
+        return solve_pipebicgstab(sol,rhs,eps_rel,eps_abs);
+    case Type::PipeCG:
+        return solve_pipecg(sol,rhs,eps_rel,eps_abs);
+    case Type::SStepCG:
+        return solve_sstepcg(sol,rhs,eps_rel,eps_abs);
+    default:
         return solve_cg(sol,rhs,eps_rel,eps_abs);
     }
 }
@@ -112,11 +179,33 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
     Lp.normalize(amrlev, mglev, r);
  
     MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
-    MultiFab::Copy(rh,   r,  0,0,ncomp,nghost);
 
     sol.setVal(0);
 
-    Real rnorm = norm_inf(r);
+    // The vector updates are fused with the reductions that follow them
+    // into single sweeps, so that rho for the next iteration comes with
+    // the update of r.  MFExpr runs on the CPU.
+    const bool fuse = Gpu::notInLaunchRegion();
+    const MultiFab* dmask = Lp.dotMask(amrlev, mglev);
+    DeferredAllReduce reduce(Lp.BottomCommunicator());
+
+    Real rnorm, rho = 0;
+    if (fuse)
+    {
+        using namespace MFExpr;
+        Real sums[1];
+        evalLocal(ncomp, nghost, assign(rh, ref(r)),
+                  norminf(ref(r), rnorm), dot(weight(dmask)*ref(r), ref(r), sums[0]));
+        reduce.addSum(sums, 1);
+        reduce.addMax(&rnorm);
+        reduce.reduce();
+        rho = sums[0];
+    }
+    else
+    {
+        MultiFab::Copy(rh,   r,  0,0,ncomp,nghost);
+        rnorm = norm_inf(r);
+    }
     const Real rnorm0   = rnorm;
 
     if ( verbose > 0 )
@@ -126,6 +215,8 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
     int ret = 0, nit = 1;
     Real rho_1 = 0, alpha = 0, omega = 0;
 
+    iter = 0;
+
     if ( rnorm0 == 0 || rnorm0 < eps_abs )
     {
         if ( verbose > 0 )
@@ -139,22 +230,33 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
 
     for (; nit <= maxiter; ++nit)
     {
-        const Real rho = dotxy(rh,r);
+        if (!fuse) rho = dotxy(rh,r);
         if ( rho == 0 ) 
 	{
             ret = 1; break;
 	}
         if ( nit == 1 )
         {
-            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+            if (fuse) {
+                MFExpr::eval(ncomp, nghost, MFExpr::assign(p, MFExpr::ref(r)),
+                             MFExpr::assign(ph, MFExpr::ref(r)));
+            } else {
+                MultiFab::Copy(p,r,0,0,ncomp,nghost);
+            }
         }
         else
         {
             const Real beta = (rho/rho_1)*(alpha/omega);
-            sxay(p, p, -omega, v, nghost);
-            sxay(p, r,   beta, p, nghost);
+            if (fuse) {
+                using namespace MFExpr;
+                eval(ncomp, nghost, assign(p, ref(r) + beta*(ref(p) - omega*ref(v))),
+                     assign(ph, ref(p)));
+            } else {
+                sxay(p, p, -omega, v, nghost);
+                sxay(p, r,   beta, p, nghost);
+            }
         }
-        MultiFab::Copy(ph,p,0,0,ncomp,nghost);
+        if (!fuse) MultiFab::Copy(ph,p,0,0,ncomp,nghost);
         Lp.apply(amrlev, mglev, v, ph, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
         Lp.normalize(amrlev, mglev, v);
 
@@ -166,13 +268,25 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
 	{
             ret = 2; break;
 	}
-        sxay(sol, sol,  alpha, ph, nghost);
-        sxay(s,     r, -alpha,  v, nghost);
+        if (fuse)
+        {
+            using namespace MFExpr;
+            evalLocal(ncomp, nghost, assign(sol, ref(sol) + alpha*ref(ph)),
+                      assign(s, ref(r) - alpha*ref(v)), assign(sh, ref(s)),
+                      norminf(ref(s), rnorm));
+            BL_PROFILE("MLCGSolver::ParallelAllReduce");
+            ParallelAllReduce::Max(rnorm, Lp.BottomCommunicator());
+        }
+        else
+        {
+            sxay(sol, sol,  alpha, ph, nghost);
+            sxay(s,     r, -alpha,  v, nghost);
 
-        //Subtract mean from s 
-//        if (Lp.isBottomSingular()) mlmg->makeSolvable(amrlev, mglev, s);
+            //Subtract mean from s 
+//            if (Lp.isBottomSingular()) mlmg->makeSolvable(amrlev, mglev, s);
  
-        rnorm = norm_inf(s);
+            rnorm = norm_inf(s);
+        }
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor() )
         {
@@ -184,7 +298,7 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
 
         if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
 
-        MultiFab::Copy(sh,s,0,0,ncomp,nghost);
+        if (!fuse) MultiFab::Copy(sh,s,0,0,ncomp,nghost);
         Lp.apply(amrlev, mglev, t, sh, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
         Lp.normalize(amrlev, mglev, t);
         //
@@ -192,7 +306,14 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
         // in the following two dotxy()s.  We do that by calculating the "local"
         // values and then reducing the two local values at the same time.
         //
-        Real tvals[2] = { dotxy(t,t,true), dotxy(t,s,true) };
+        Real tvals[2];
+        if (fuse) {
+            using namespace MFExpr;
+            evalLocal(ncomp, 0, dot(weight(dmask)*ref(t), ref(t), tvals[0]),
+                      dot(weight(dmask)*ref(t), ref(s), tvals[1]));
+        } else {
+            dotxy({&t,&t}, {&t,&s}, tvals, true);
+        }
 
         BL_PROFILE_VAR("MLCGSolver::ParallelAllReduce", blp_par);
         ParallelAllReduce::Sum(tvals,2,Lp.BottomCommunicator());
@@ -206,12 +327,29 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
 	{
             ret = 3; break;
 	}
-        sxay(sol, sol,  omega, sh, nghost);
-        sxay(r,     s, -omega,  t, nghost);
+        if (fuse)
+        {
+            using namespace MFExpr;
+            Real sums[1];
+            evalLocal(ncomp, nghost, assign(sol, ref(sol) + omega*ref(sh)),
+                      assign(r, ref(s) - omega*ref(t)),
+                      norminf(ref(r), rnorm), dot(weight(dmask)*ref(rh), ref(r), sums[0]));
+            reduce.addSum(sums, 1);
+            reduce.addMax(&rnorm);
+            reduce.reduce();
+            rho_1 = rho;
+            rho = sums[0];
+        }
+        else
+        {
+            sxay(sol, sol,  omega, sh, nghost);
+            sxay(r,     s, -omega,  t, nghost);
 
-//        if (Lp.isBottomSingular()) mlmg->makeSolvable(amrlev, mglev, r);
+//            if (Lp.isBottomSingular()) mlmg->makeSolvable(amrlev, mglev, r);
 
-        rnorm = norm_inf(r);
+            rnorm = norm_inf(r);
+            rho_1 = rho;
+        }
 
         if ( verbose > 2 )
         {
@@ -227,9 +365,10 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
 	{
             ret = 4; break;
 	}
-        rho_1 = rho;
     }
 
+    iter = std::min(nit, maxiter);
+
     if ( verbose > 0 )
     {
         amrex::Print() << "MLCGSolver_BiCGStab: Final: Iteration "
@@ -286,7 +425,27 @@ MLCGSolver::solve_cg (MultiFab&       sol,
 
     sol.setVal(0);
 
-    Real       rnorm    = norm_inf(r);
+    // As in solve_bicgstab, rho for the next iteration comes with the
+    // update of r.  Without a preconditioner z is r.
+    const bool fuse = Gpu::notInLaunchRegion();
+    const MultiFab* dmask = Lp.dotMask(amrlev, mglev);
+    DeferredAllReduce reduce(Lp.BottomCommunicator());
+
+    Real rnorm, rho = 0;
+    if (fuse)
+    {
+        using namespace MFExpr;
+        Real sums[1];
+        evalLocal(ncomp, 0, norminf(ref(r), rnorm), dot(weight(dmask)*ref(r), ref(r), sums[0]));
+        reduce.addSum(sums, 1);
+        reduce.addMax(&rnorm);
+        reduce.reduce();
+        rho = sums[0];
+    }
+    else
+    {
+        rnorm = norm_inf(r);
+    }
     const Real rnorm0   = rnorm;
 
     if ( verbose > 0 )
@@ -298,6 +457,8 @@ MLCGSolver::solve_cg (MultiFab&       sol,
     int  ret           = 0;
     int  nit           = 1;
 
+    iter = 0;
+
     if ( rnorm0 == 0 || rnorm0 < eps_abs )
     {
         if ( verbose > 0 ) {
@@ -310,9 +471,12 @@ MLCGSolver::solve_cg (MultiFab&       sol,
 
     for (; nit <= maxiter; ++nit)
     {
-        MultiFab::Copy(z,r,0,0,ncomp,nghost);
+        if (!fuse)
+        {
+            MultiFab::Copy(z,r,0,0,ncomp,nghost);
 
-        Real rho = dotxy(z,r);
+            rho = dotxy(z,r);
+        }
 
         if ( rho == 0 )
         {
@@ -320,12 +484,16 @@ MLCGSolver::solve_cg (MultiFab&       sol,
         }
         if (nit == 1)
         {
-            MultiFab::Copy(p,z,0,0,ncomp,nghost);
+            MultiFab::Copy(p,fuse ? r : z,0,0,ncomp,nghost);
         }
         else
         {
             Real beta = rho/rho_1;
-            sxay(p, z, beta, p, nghost);
+            if (fuse) {
+                MFExpr::eval(ncomp, nghost, MFExpr::assign(p, MFExpr::ref(r) + beta*MFExpr::ref(p)));
+            } else {
+                sxay(p, z, beta, p, nghost);
+            }
         }
         Lp.apply(amrlev, mglev, q, p, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
 
@@ -346,9 +514,25 @@ MLCGSolver::solve_cg (MultiFab&       sol,
                            << " rho " << rho
                            << " alpha " << alpha << '\n';
         }
-        sxay(sol, sol, alpha, p, nghost);
-        sxay(  r,   r,-alpha, q, nghost);
-        rnorm = norm_inf(r);
+        rho_1 = rho;
+        if (fuse)
+        {
+            using namespace MFExpr;
+            Real sums[1];
+            evalLocal(ncomp, nghost, assign(sol, ref(sol) + alpha*ref(p)),
+                      assign(r, ref(r) - alpha*ref(q)),
+                      norminf(ref(r), rnorm), dot(weight(dmask)*ref(r), ref(r), sums[0]));
+            reduce.addSum(sums, 1);
+            reduce.addMax(&rnorm);
+            reduce.reduce();
+            rho = sums[0];
+        }
+        else
+        {
+            sxay(sol, sol, alpha, p, nghost);
+            sxay(  r,   r,-alpha, q, nghost);
+            rnorm = norm_inf(r);
+        }
 
         if ( verbose > 2 )
         {
@@ -359,10 +543,10 @@ MLCGSolver::solve_cg (MultiFab&       sol,
         }
 
         if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
-
-        rho_1 = rho;
     }
     
+    iter = std::min(nit, maxiter);
+
     if ( verbose > 0 )
     {
         amrex::Print() << "MLCGSolver_cg: Final Iteration"
@@ -391,6 +575,618 @@ MLCGSolver::solve_cg (MultiFab&       sol,
     return ret;
 }
 
+//
+// Pipelined BiCGStab (Cools & Vanroose, Parallel Computing 65, 2017) on
+// the same Jacobi-scaled system as solve_bicgstab.  Each of the two
+// reductions per iteration runs while the next operator apply is done.
+//
+int
+MLCGSolver::solve_pipebicgstab (MultiFab&       sol,
+                                const MultiFab& rhs,
+                                Real            eps_rel,
+                                Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipebicgstab");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // r, w and z are the inputs of operator applies and need ghost cells
+    MultiFab r(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab w(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab z(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    r.setVal(0.0);
+    w.setVal(0.0);
+    z.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab rh   (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab t    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab v    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab y    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    auto op = [&] (MultiFab& out, MultiFab& in) {
+        Lp.apply(amrlev, mglev, out, in, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, out);
+    };
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+    Lp.normalize(amrlev, mglev, r);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+    MultiFab::Copy(rh,   r,  0,0,ncomp,nghost);
+
+    sol.setVal(0);
+
+    Real rnorm = norm_inf(r);
+    const Real rnorm0 = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeBiCGStab: Initial error (error0) =        " << rnorm0 << '\n';
+    }
+
+    iter = 0;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return 0;
+    }
+
+    op(w, r);
+    op(t, w);
+
+    Real rho, alpha, beta = 0, omega = 0;
+    int ret = 0, nit = 1;
+    {
+        Real dots[2];
+        dotxy({&rh,&rh}, {&r,&w}, dots, true);
+        BL_PROFILE_VAR("MLCGSolver::ParallelAllReduce", blp_par);
+        ParallelAllReduce::Sum(dots,2,Lp.BottomCommunicator());
+        BL_PROFILE_VAR_STOP(blp_par);
+        rho = dots[0];
+        alpha = (dots[1] != 0) ? rho/dots[1] : 0;
+        if (rho == 0) {
+            ret = 1;
+        } else if (dots[1] == 0) {
+            ret = 2;
+        }
+    }
+
+    DeferredAllReduce reduce(Lp.BottomCommunicator());
+
+    for (; nit <= maxiter && ret == 0; ++nit)
+    {
+        if ( nit == 1 )
+        {
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(z,t,0,0,ncomp,nghost);
+        }
+        else
+        {
+            sxay(p, p, -omega, s, nghost);
+            sxay(p, r,   beta, p, nghost);
+            sxay(s, s, -omega, z, nghost);
+            sxay(s, w,   beta, s, nghost);
+            sxay(z, z, -omega, v, nghost);
+            sxay(z, t,   beta, z, nghost);
+        }
+        sxay(q, r, -alpha, s, nghost);
+        sxay(y, w, -alpha, z, nghost);
+
+        Real qy[2];
+        dotxy({&q,&y}, {&y,&y}, qy, true);
+        Real qnorm = norm_inf(q,true);
+        reduce.addSum(qy, 2);
+        reduce.addMax(&qnorm);
+        reduce.start();
+        op(v, z);
+        reduce.wait();
+
+        rnorm = qnorm;
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: Half Iter "
+                           << std::setw(11) << nit
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs )
+        {
+            sxay(sol, sol, alpha, p, nghost);
+            break;
+        }
+
+        if ( qy[1] )
+        {
+            omega = qy[0]/qy[1];
+        }
+        else
+        {
+            ret = 3; break;
+        }
+
+        sxay(sol, sol, alpha, p, nghost);
+        sxay(sol, sol, omega, q, nghost);
+        sxay(r, q, -omega, y, nghost);
+        sxay(t, t, -alpha, v, nghost);
+        sxay(w, y, -omega, t, nghost);
+
+        Real dots[4];
+        dotxy({&rh,&rh,&rh,&rh}, {&r,&w,&s,&z}, dots, true);
+        Real rn = norm_inf(r,true);
+        reduce.addSum(dots, 4);
+        reduce.addMax(&rn);
+        reduce.start();
+        op(t, w);
+        reduce.wait();
+
+        rnorm = rn;
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: Iteration "
+                           << std::setw(11) << nit
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+
+        if ( omega == 0 )
+        {
+            ret = 4; break;
+        }
+        if ( dots[0] == 0 )
+        {
+            ret = 1; break;
+        }
+        beta = (alpha/omega)*(dots[0]/rho);
+        const Real den = dots[1] + beta*dots[2] - beta*omega*dots[3];
+        if ( den == 0 )
+        {
+            ret = 2; break;
+        }
+        alpha = dots[0]/den;
+        rho = dots[0];
+    }
+
+    iter = std::min(nit, maxiter);
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeBiCGStab: Final: Iteration "
+                       << std::setw(4) << nit
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs)
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipeBiCGStab:: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
+//
+// Pipelined CG (Ghysels & Vanroose, Parallel Computing 40, 2014).  The
+// dot products and the residual norm of each iteration are reduced while
+// the operator is applied to w.
+//
+int
+MLCGSolver::solve_pipecg (MultiFab&       sol,
+                          const MultiFab& rhs,
+                          Real            eps_rel,
+                          Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipecg");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // r and w are the inputs of operator applies and need ghost cells
+    MultiFab r(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab w(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    r.setVal(0.0);
+    w.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab z    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+
+    sol.setVal(0);
+
+    Real       rnorm    = norm_inf(r);
+    const Real rnorm0   = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeCG: Initial error (error0) :        " << rnorm0 << '\n';
+    }
+
+    iter = 0;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 ) {
+            amrex::Print() << "MLCGSolver_PipeCG: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return 0;
+    }
+
+    Lp.apply(amrlev, mglev, w, r, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+
+    DeferredAllReduce reduce(Lp.BottomCommunicator());
+
+    Real gamma_1 = 0, alpha_1 = 0;
+    int  ret = 0;
+    int  nit = 0;
+
+    for (;;)
+    {
+        // The norm of r is that of the previous iteration, so the last
+        // apply below is not used.  That is the price of the overlap.
+        Real dots[2];
+        dotxy({&r,&w}, {&r,&r}, dots, true);
+        Real rn = norm_inf(r,true);
+        reduce.addSum(dots, 2);
+        reduce.addMax(&rn);
+        reduce.start();
+        Lp.apply(amrlev, mglev, q, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        reduce.wait();
+
+        rnorm = rn;
+
+        if ( verbose > 2 && nit > 0 )
+        {
+            amrex::Print() << "MLCGSolver_PipeCG:   Iteration"
+                           << std::setw(4) << nit
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+        if ( nit == maxiter ) break;
+        ++nit;
+
+        const Real gamma = dots[0];
+        const Real delta = dots[1];
+        if ( gamma == 0 )
+        {
+            ret = 1; break;
+        }
+        Real beta = 0, den = delta;
+        if ( nit > 1 )
+        {
+            beta = gamma/gamma_1;
+            den = delta - beta*gamma/alpha_1;
+        }
+        if ( den == 0 )
+        {
+            ret = 1; break;
+        }
+        const Real alpha = gamma/den;
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipeCG:"
+                           << " nit " << nit
+                           << " gamma " << gamma
+                           << " alpha " << alpha << '\n';
+        }
+
+        if ( nit == 1 )
+        {
+            MultiFab::Copy(z,q,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+        }
+        else
+        {
+            sxay(z, q, beta, z, nghost);
+            sxay(s, w, beta, s, nghost);
+            sxay(p, r, beta, p, nghost);
+        }
+        sxay(sol, sol,  alpha, p, nghost);
+        sxay(  r,   r, -alpha, s, nghost);
+        sxay(  w,   w, -alpha, z, nghost);
+
+        gamma_1 = gamma;
+        alpha_1 = alpha;
+    }
+
+    iter = nit;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeCG: Final Iteration"
+                       << std::setw(4) << nit
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 &&  rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipeCG: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
+//
+// s-step CG (Chronopoulos & Gear, J. Comput. Appl. Math. 25, 1989) with
+// the monomial basis [r, Ar, ..., A^{s-1}r].  All the inner products of
+// the s iterations of a block, including the Gram matrix of the next
+// block, are reduced at once.  The Gram matrices are diagonally scaled
+// before they are factored, which keeps small s usable in spite of the
+// growth of the monomial basis.
+//
+int
+MLCGSolver::solve_sstepcg (MultiFab&       sol,
+                           const MultiFab& rhs,
+                           Real            eps_rel,
+                           Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::sstepcg");
+
+    const int ncomp = sol.nComp();
+    const int ns = std::max(sstep, 1);
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // V[j] = A^j r.  All but the last are operator inputs.
+    Vector<MultiFab> V(ns+1);
+    for (auto& mf : V) {
+        mf.define(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+        mf.setVal(0.0);
+    }
+    Vector<MultiFab> P(ns), AP(ns), Pn(ns), APn(ns);
+    for (int j = 0; j < ns; ++j) {
+        P  [j].define(ba, dm, ncomp, nghost, MFInfo(), factory);
+        AP [j].define(ba, dm, ncomp, nghost, MFInfo(), factory);
+        Pn [j].define(ba, dm, ncomp, nghost, MFInfo(), factory);
+        APn[j].define(ba, dm, ncomp, nghost, MFInfo(), factory);
+    }
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab r    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    Lp.correctionResidual(amrlev, mglev, V[0], sol, rhs, MLLinOp::BCMode::Homogeneous);
+    MultiFab::Copy(r,V[0],0,0,ncomp,nghost);
+
+    sol.setVal(0);
+
+    Real       rnorm    = norm_inf(r);
+    const Real rnorm0   = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_SStepCG: Initial error (error0) :        " << rnorm0 << '\n';
+    }
+
+    iter = 0;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 ) {
+            amrex::Print() << "MLCGSolver_SStepCG: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return 0;
+    }
+
+    // Column-major ns x ns matrices: RAR = R^T A R, C = P^T A R,
+    // D = R^T A P and W = P^T A P, where R = [V_0 .. V_{s-1}].  m = R^T r.
+    // The operator is not exactly symmetric (e.g., high-order Dirichlet
+    // boundary stencils), so no moment is derived from another by symmetry.
+    Vector<Real> buf(3*ns*ns + ns);
+    Vector<Real> RAR(ns*ns), C(ns*ns), D(ns*ns), W(ns*ns), B(ns*ns), m(ns), a(ns);
+
+    DeferredAllReduce reduce(Lp.BottomCommunicator());
+    Vector<const MultiFab*> xs, ys;
+
+    // Build the basis from V[0] and reduce all its inner products at once.
+    auto krylov_block = [&] (bool with_c) -> Real
+    {
+        for (int j = 0; j < ns; ++j) {
+            Lp.apply(amrlev, mglev, V[j+1], V[j], MLLinOp::BCMode::Homogeneous,
+                     MLLinOp::StateMode::Correction);
+        }
+        xs.clear();
+        ys.clear();
+        for (int j = 0; j < ns; ++j) {
+            for (int i = 0; i < ns; ++i) {
+                xs.push_back(&V[i]);
+                ys.push_back(&V[j+1]);
+            }
+        }
+        for (int i = 0; i < ns; ++i) {
+            xs.push_back(&V[i]);
+            ys.push_back(&V[0]);
+        }
+        if (with_c) {
+            for (int j = 0; j < ns; ++j) {
+                for (int l = 0; l < ns; ++l) {
+                    xs.push_back(&P[l]);
+                    ys.push_back(&V[j+1]);
+                }
+            }
+            for (int l = 0; l < ns; ++l) {
+                for (int i = 0; i < ns; ++i) {
+                    xs.push_back(&V[i]);
+                    ys.push_back(&AP[l]);
+                }
+            }
+        }
+        int n = xs.size();
+        dotxy(xs, ys, buf.data(), true);
+        Real rn = norm_inf(V[0],true);
+        reduce.addSum(buf.data(), n);
+        reduce.addMax(&rn);
+        reduce.reduce();
+
+        n = 0;
+        for (int k = 0; k < ns*ns; ++k) {
+            RAR[k] = buf[n++];
+        }
+        for (int i = 0; i < ns; ++i) {
+            m[i] = buf[n++];
+        }
+        if (with_c) {
+            for (int k = 0; k < ns*ns; ++k) {
+                C[k] = buf[n++];
+            }
+            for (int k = 0; k < ns*ns; ++k) {
+                D[k] = buf[n++];
+            }
+        }
+        return rn;
+    };
+
+    krylov_block(false);
+    for (int j = 0; j < ns; ++j) {
+        MultiFab::Copy( P[j], V[j  ],0,0,ncomp,nghost);
+        MultiFab::Copy(AP[j], V[j+1],0,0,ncomp,nghost);
+    }
+    W = RAR;
+
+    int ret = 0;
+    int nit = 0;
+
+    while (nit < maxiter)
+    {
+        a = m;
+        if (gram_solve(W, ns, a.data(), 1) == 0)
+        {
+            ret = 1; break;
+        }
+        for (int j = 0; j < ns; ++j) {
+            MultiFab::Saxpy(sol,  a[j],  P[j], 0, 0, ncomp, nghost);
+            MultiFab::Saxpy(r  , -a[j], AP[j], 0, 0, ncomp, nghost);
+        }
+        nit += ns;
+
+        MultiFab::Copy(V[0],r,0,0,ncomp,nghost);
+        rnorm = krylov_block(true);
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_SStepCG:  Iteration"
+                           << std::setw(4) << nit
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+
+        // P_new = R - P B with B = W^{-1} C, which makes P^T A P_new = 0,
+        // and then W_new = P_new^T A P_new = RAR - D B.
+        B = C;
+        gram_solve(W, ns, B.data(), ns);
+        for (int j = 0; j < ns; ++j) {
+            for (int i = 0; i < ns; ++i) {
+                Real db = 0;
+                for (int l = 0; l < ns; ++l) db += D[i+l*ns]*B[l+j*ns];
+                W[i+j*ns] = RAR[i+j*ns] - db;
+            }
+        }
+        for (int j = 0; j < ns; ++j) {
+            MultiFab::Copy( Pn[j], V[j  ],0,0,ncomp,nghost);
+            MultiFab::Copy(APn[j], V[j+1],0,0,ncomp,nghost);
+            for (int l = 0; l < ns; ++l) {
+                MultiFab::Saxpy( Pn[j], -B[l+j*ns],  P[l], 0, 0, ncomp, nghost);
+                MultiFab::Saxpy(APn[j], -B[l+j*ns], AP[l], 0, 0, ncomp, nghost);
+            }
+        }
+        std::swap(P, Pn);
+        std::swap(AP, APn);
+    }
+
+    iter = nit;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_SStepCG: Final Iteration"
+                       << std::setw(4) << nit
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 &&  rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_SStepCG: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
 Real
 MLCGSolver::dotxy (const MultiFab& r, const MultiFab& z, bool local)
 {
@@ -401,6 +1197,17 @@ MLCGSolver::dotxy (const MultiFab& r, const MultiFab& z, bool local)
     return result;
 }
 
+void
+MLCGSolver::dotxy (const Vector<const MultiFab*>& x, const Vector<const MultiFab*>& y,
+                   Real* result, bool local)
+{
+    MultiFab::MultiDot(x, 0, y, 0, Lp.getNComp(), 0, result, true, Lp.dotMask(amrlev, mglev));
+    if (!local) {
+        BL_PROFILE("MLCGSolver::ParallelAllReduce");
+        ParallelAllReduce::Sum(result, x.size(), Lp.BottomCommunicator());
+    }
+}
+
 Real
 MLCGSolver::norm_inf (const MultiFab& res, bool local)
 {
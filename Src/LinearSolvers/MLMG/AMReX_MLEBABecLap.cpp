@@ -288,9 +288,11 @@ MLEBABecLap::averageDownCoeffs ()
 
     for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev) {
         for (int mglev = 0; mglev < m_num_mg_levels[amrlev]; ++mglev) {
+            Vector<FabArray<FArrayBox>*> bcoefs;
             for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-                m_b_coeffs[amrlev][mglev][idim].FillBoundary(m_geom[amrlev][mglev].periodicity());
+                bcoefs.push_back(&m_b_coeffs[amrlev][mglev][idim]);
             }
+            amrex::FillBoundary(bcoefs, m_geom[amrlev][mglev].periodicity());
         }
     }
 }
@@ -39,6 +39,49 @@
 
 namespace amrex {
 
+namespace {
+
+// dst = scale*src, converting between single and double precision
+template <class DMF, class SMF>
+void copyConvert (DMF& dst, const SMF& src, int ncomp, Real scale)
+{
+    using T = typename DMF::value_type;
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(dst,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& d = dst.array(mfi);
+        const auto& a = src.const_array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            d(i,j,k,n) = static_cast<T>(scale*a(i,j,k,n));
+        });
+    }
+}
+
+// dst += scale*src, converting between single and double precision
+template <class DMF, class SMF>
+void addConvert (DMF& dst, const SMF& src, int ncomp, Real scale)
+{
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(dst,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& d = dst.array(mfi);
+        const auto& a = src.const_array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            d(i,j,k,n) += scale*a(i,j,k,n);
+        });
+    }
+}
+
+}
+
 MLMG::MLMG (MLLinOp& a_lp)
     : linop(a_lp),
       namrlevs(a_lp.NAMRLevels()),
@@ -68,6 +111,7 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     }
     
     bool is_nsolve = linop.m_parent;
+    num_iters = 0;
 
     Real solve_start_time = amrex::second();
 
@@ -75,6 +119,16 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
 
     prepareForSolve(a_sol, a_rhs);
 
+    const bool mixed_precision = do_mixed_precision && namrlevs == 1
+        && cf_strategy == CFStrategy::none && linop.supportsSinglePrecision();
+    if (mixed_precision) {
+        prepareForSingle();
+    }
+    if (do_mixed_precision && verbose >= 1) {
+        amrex::Print() << "MLMG: " << (mixed_precision ? "Using" : "Not using")
+                       << " mixed precision V-cycle\n";
+    }
+
     computeMLResidual(finest_amr_lev);
 
     int ncomp = linop.getNComp();
@@ -115,7 +169,12 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
         const int niters = do_fixed_number_of_iters ? do_fixed_number_of_iters : max_iters;
         for (int iter = 0; iter < niters; ++iter)
         {
-            oneIter(iter);
+            if (mixed_precision) {
+                oneIterSingle();
+            } else {
+                oneIter(iter);
+            }
+            num_iters = iter+1;
 
             converged = false;
 
@@ -264,6 +323,33 @@ void MLMG::oneIter (int iter)
     averageDownAndSync();
 }
 
+// Iterative refinement on a single AMR level.  The V-cycle on the
+// correction is done in single precision.
+// in  : Residual (res) on the finest MG level
+// out : sol
+void
+MLMG::oneIterSingle ()
+{
+    BL_PROFILE("MLMG::oneIterSingle()");
+
+    const int ncomp = linop.getNComp();
+
+    if (linop.isSingular(0))
+    {
+        makeSolvable(0,0,res[0][0]);
+    }
+
+    // Scale the residual to O(1) so that it cannot underflow in single precision.
+    const Real resnorm = ResNormInf(0);
+    if (resnorm == 0.0) return;
+
+    copyConvert(*res_single[0], res[0][0], ncomp, 1.0/resnorm);
+
+    mgVcycleSingle();
+
+    addConvert(*sol[0], *cor_single[0], ncomp, resnorm);
+}
+
 // Compute multi-level Residual (res) up to amrlevmax.
 void
 MLMG::computeMLResidual (int amrlevmax)
@@ -388,6 +474,52 @@ std::string make_str (Ts... xs) {
 
 }
 
+// Same as mgVcycle(0,0), but in single precision except for the bottom solve.
+// in   : Residual (res_single) on MG level 0
+// out  : Correction (cor_single) on all MG levels
+void
+MLMG::mgVcycleSingle ()
+{
+    BL_PROFILE("MLMG::mgVcycleSingle()");
+
+    const int amrlev = 0;
+    const int mglev_bottom = linop.NMGLevels(amrlev) - 1;
+    const int ncomp = linop.getNComp();
+
+    for (int mglev = 0; mglev < mglev_bottom; ++mglev)
+    {
+        cor_single[mglev]->setVal(0.0f);
+        bool skip_fillboundary = true;
+        for (int i = 0; i < nu1; ++i) {
+            linop.smoothSingle(amrlev, mglev, *cor_single[mglev], *res_single[mglev],
+                               skip_fillboundary);
+            skip_fillboundary = false;
+        }
+
+        // rescor = res - L(cor)
+        linop.correctionResidualSingle(amrlev, mglev, *rescor_single[mglev],
+                                       *cor_single[mglev], *res_single[mglev]);
+
+        // res_crse = R(rescor_fine)
+        linop.restrictionSingle(amrlev, mglev+1, *res_single[mglev+1], *rescor_single[mglev]);
+    }
+
+    BL_PROFILE_VAR("MLMG::mgVcycleSingle_bottom", blp_bottom);
+    copyConvert(res[amrlev][mglev_bottom], *res_single[mglev_bottom], ncomp, 1.0);
+    bottomSolve();
+    copyConvert(*cor_single[mglev_bottom], *cor[amrlev][mglev_bottom], ncomp, 1.0);
+    BL_PROFILE_VAR_STOP(blp_bottom);
+
+    for (int mglev = mglev_bottom-1; mglev >= 0; --mglev)
+    {
+        // cor_fine += I(cor_crse)
+        addInterpCorrectionSingle(mglev);
+        for (int i = 0; i < nu2; ++i) {
+            linop.smoothSingle(amrlev, mglev, *cor_single[mglev], *res_single[mglev]);
+        }
+    }
+}
+
 // in   : Residual (res) 
 // out  : Correction (cor) from bottom to this function's local top
 void
@@ -823,6 +955,36 @@ MLMG::addInterpCorrection (int alev, int mglev)
     linop.interpolation(alev, mglev, fine_cor, *cmf);
 }
 
+// (Fine MG level correction) += I(Coarse MG level correction) in single precision
+void
+MLMG::addInterpCorrectionSingle (int mglev)
+{
+    BL_PROFILE("MLMG::addInterpCorrectionSingle()");
+
+    const int ncomp = linop.getNComp();
+
+    const fMultiFab& crse_cor = *cor_single[mglev+1];
+    fMultiFab&       fine_cor = *cor_single[mglev  ];
+
+    fMultiFab cfine;
+    const fMultiFab* cmf;
+
+    if (amrex::isMFIterSafe(crse_cor, fine_cor))
+    {
+        cmf = &crse_cor;
+    }
+    else
+    {
+        BoxArray cba = fine_cor.boxArray();
+        cba.coarsen(2);
+        cfine.define(cba, fine_cor.DistributionMap(), ncomp, 0);
+        cfine.ParallelCopy(crse_cor);
+        cmf = &cfine;
+    }
+
+    linop.interpolationSingle(0, mglev, fine_cor, *cmf);
+}
+
 // Compute rescor = res - L(cor)
 // in   : res
 // inout: cor (out due to FillBoundary in linop.correctionResidual)
@@ -925,6 +1087,12 @@ MLMG::actualBottomSolve ()
             if (bottom_solver == BottomSolver::cg ||
                 bottom_solver == BottomSolver::cgbicg) {
                 cg_type = MLCGSolver::Type::CG;
+            } else if (bottom_solver == BottomSolver::pipecg) {
+                cg_type = MLCGSolver::Type::PipeCG;
+            } else if (bottom_solver == BottomSolver::pipebicgstab) {
+                cg_type = MLCGSolver::Type::PipeBiCGStab;
+            } else if (bottom_solver == BottomSolver::sstepcg) {
+                cg_type = MLCGSolver::Type::SStepCG;
             } else {
                 cg_type = MLCGSolver::Type::BiCGStab;
             }
@@ -970,9 +1138,11 @@ MLMG::bottomSolveWithCG (MultiFab& x, const MultiFab& b, MLCGSolver::Type type)
     cg_solver.setSolver(type);
     cg_solver.setVerbose(bottom_verbose);
     cg_solver.setMaxIter(bottom_maxiter);
+    cg_solver.setSStep(bottom_sstep);
     if (cf_strategy == CFStrategy::ghostnodes) cg_solver.setNGhost(linop.getNGrow());
 
     int ret = cg_solver.solve(x, b, bottom_reltol, bottom_abstol);
+    bottom_iters += cg_solver.getNumIters();
     if (ret != 0 && verbose > 1) {
         amrex::Print() << "MLMG: Bottom solve failed.\n";
     }
@@ -1117,6 +1287,7 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
     AMREX_ASSERT(namrlevs <= a_rhs.size());
 
     timer.assign(ntimers, 0.0);
+    bottom_iters = 0;
 
     const int ncomp = linop.getNComp();
     int nghost = 0;
@@ -1300,6 +1471,28 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
     }
 }
 
+void
+MLMG::prepareForSingle ()
+{
+    BL_PROFILE("MLMG::prepareForSingle()");
+
+    const int ncomp = linop.getNComp();
+    const int nmglevs = linop.NMGLevels(0);
+    if (!cor_single.empty()) return;
+
+    cor_single.resize(nmglevs);
+    res_single.resize(nmglevs);
+    rescor_single.resize(nmglevs);
+    for (int mglev = 0; mglev < nmglevs; ++mglev)
+    {
+        const BoxArray& ba = res[0][mglev].boxArray();
+        const DistributionMapping& dm = res[0][mglev].DistributionMap();
+        cor_single   [mglev].reset(new fMultiFab(ba, dm, ncomp, 1));
+        res_single   [mglev].reset(new fMultiFab(ba, dm, ncomp, 0));
+        rescor_single[mglev].reset(new fMultiFab(ba, dm, ncomp, 0));
+    }
+}
+
 void
 MLMG::prepareForNSolve ()
 {
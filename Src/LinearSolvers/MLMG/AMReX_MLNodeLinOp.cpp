@@ -131,23 +131,24 @@ MLNodeLinOp::smooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
 Real
 MLNodeLinOp::xdoty (int amrlev, int mglev, const MultiFab& x, const MultiFab& y, bool local) const
 {
-    AMREX_ASSERT(amrlev==0);
-    AMREX_ASSERT(mglev+1==m_num_mg_levels[0] || mglev==0);
-    const auto& mask = (mglev+1 == m_num_mg_levels[0]) ? m_bottom_dot_mask : m_coarse_dot_mask;
     const int ncomp = y.nComp();
     const int nghost = 0;
-    MultiFab tmp(x.boxArray(), x.DistributionMap(), ncomp, 0);
-    MultiFab::Copy(tmp, x, 0, 0, ncomp, nghost);
-    for (int i = 0; i < ncomp; i++) {
-        MultiFab::Multiply(tmp, mask, 0, i, 1, nghost);
-    }
-    Real result = MultiFab::Dot(tmp,0,y,0,ncomp,nghost,true);
+    Real result;
+    MultiFab::MultiDot({&x}, 0, {&y}, 0, ncomp, nghost, &result, true, dotMask(amrlev, mglev));
     if (!local) {
         ParallelAllReduce::Sum(result, Communicator(amrlev, mglev));
     }
     return result;
 }
 
+const MultiFab*
+MLNodeLinOp::dotMask (int amrlev, int mglev) const
+{
+    AMREX_ASSERT(amrlev==0);
+    AMREX_ASSERT(mglev+1==m_num_mg_levels[0] || mglev==0);
+    return (mglev+1 == m_num_mg_levels[0]) ? &m_bottom_dot_mask : &m_coarse_dot_mask;
+}
+
 void
 MLNodeLinOp::applyInhomogNeumannTerm (int amrlev, MultiFab& rhs) const
 {
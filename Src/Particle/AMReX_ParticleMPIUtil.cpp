@@ -24,13 +24,29 @@ namespace amrex {
     long doHandShake(const std::map<int, Vector<char> >& not_ours,
                      Vector<long>& Snds, Vector<long>& Rcvs)
     {
-        long NumSnds = CountSnds(not_ours, Snds);
+        for (const auto& kv : not_ours) Snds[kv.first] = kv.second.size();
+        return doHandShake(Snds, Rcvs);
+    }
+
+    long doHandShakeLocal(const std::map<int, Vector<char> >& not_ours,
+                          const Vector<int>& neighbor_procs, Vector<long>& Snds, Vector<long>& Rcvs)
+    {
+        for (const auto& kv : not_ours) Snds[kv.first] = kv.second.size();
+        return doHandShakeLocal(Snds, neighbor_procs, Rcvs);
+    }
+
+    long doHandShake(const Vector<long>& Snds, Vector<long>& Rcvs)
+    {
+        long NumSnds = 0;
+        for (const auto n : Snds) NumSnds += n;
+
+        ParallelDescriptor::ReduceLongMax(NumSnds);
         if (NumSnds == 0) return NumSnds;
 
         BL_COMM_PROFILE(BLProfiler::Alltoall, sizeof(long),
                         ParallelDescriptor::MyProc(), BLProfiler::BeforeCall());
         
-        BL_MPI_REQUIRE( MPI_Alltoall(Snds.dataPtr(),
+        BL_MPI_REQUIRE( MPI_Alltoall(const_cast<long*>(Snds.dataPtr()),
                                      1,
                                      ParallelDescriptor::Mpi_typemap<long>::type(),
                                      Rcvs.dataPtr(),
@@ -46,16 +62,11 @@ namespace amrex {
         return NumSnds;
     }
 
-    long doHandShakeLocal(const std::map<int, Vector<char> >& not_ours,
-                          const Vector<int>& neighbor_procs, Vector<long>& Snds, Vector<long>& Rcvs)
+    long doHandShakeLocal(const Vector<long>& Snds, const Vector<int>& neighbor_procs,
+                          Vector<long>& Rcvs)
     {
-
-        long NumSnds = 0;        
-        for (const auto& kv : not_ours)
-        {
-            NumSnds       += kv.second.size();
-            Snds[kv.first] = kv.second.size();
-        }
+        long NumSnds = 0;
+        for (const auto n : Snds) NumSnds += n;
 
         const int SeqNum = ParallelDescriptor::SeqNum();
         
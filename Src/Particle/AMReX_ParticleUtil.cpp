@@ -1,4 +1,8 @@
 #include <AMReX_ParticleUtil.H>
+#include <AMReX_BoxIterator.H>
+
+#include <algorithm>
+#include <numeric>
 
 namespace amrex
 {
@@ -113,4 +117,42 @@ Vector<int> computeNeighborProcs (const ParGDBBase* a_gdb, int ngrow)
     return neighbor_procs;
 }
 
+Vector<int> mortonCellOrder (const Box& bx, const IntVect& origin)
+{
+    const int ncells = bx.numPts();
+    Vector<std::uint64_t> keys(ncells);
+    for (BoxIterator bi(bx); bi.ok(); ++bi) {
+        keys[bx.index(bi())] = mortonKey(bi() - origin);
+    }
+    Vector<int> cells(ncells);
+    std::iota(cells.begin(), cells.end(), 0);
+    std::sort(cells.begin(), cells.end(),
+              [&] (int a, int b) { return keys[a] < keys[b]; });
+    Vector<int> order(ncells);
+    for (int r = 0; r < ncells; ++r) {
+        order[cells[r]] = r;
+    }
+    return order;
+}
+
+bool countingSortBins (const int* bins, int np, int nbins, int* perm, int* offsets)
+{
+    std::fill(offsets, offsets+nbins+1, 0);
+    bool sorted = true;
+    for (int i = 0; i < np; ++i) {
+        ++offsets[bins[i]+1];
+        if (i > 0 && bins[i-1] > bins[i]) sorted = false;
+    }
+    for (int b = 0; b < nbins; ++b) {
+        offsets[b+1] += offsets[b];
+    }
+    if (sorted) return false;
+
+    Vector<int> next(offsets, offsets+nbins);
+    for (int i = 0; i < np; ++i) {
+        perm[next[bins[i]]++] = i;
+    }
+    return true;
+}
+
 }
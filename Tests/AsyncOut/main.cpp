@@ -0,0 +1,287 @@
+#include <string>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_PROB_AMR_F.H>
+#include <AMReX_AsyncOut.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+using namespace amrex;
+
+namespace {
+
+// Never called, the domain is periodic.
+void nullfill (Box const& /*bx*/, FArrayBox& /*data*/, const int /*dcomp*/,
+               const int /*numcomp*/, Geometry const& /*geom*/, const Real /*time*/,
+               const Vector<BCRec>& /*bcr*/, const int /*bcomp*/, const int /*scomp*/)
+{}
+
+// One state, phi, that depends on the global index and the level, and
+// that each step adds one to.
+class OutLevel
+    :
+    public AmrLevel
+{
+public:
+
+    OutLevel () {}
+
+    OutLevel (Amr& papa, int lev, const Geometry& level_geom, const BoxArray& bl,
+              const DistributionMapping& dm, Real time)
+        : AmrLevel(papa, lev, level_geom, bl, dm, time) {}
+
+    static void variableSetUp ()
+    {
+        desc_lst.addDescriptor(0, IndexType::TheCellType(), StateDescriptor::Point,
+                               0, 1, &cell_cons_interp);
+        int lo_bc[BL_SPACEDIM], hi_bc[BL_SPACEDIM];
+        for (int i = 0; i < BL_SPACEDIM; ++i) {
+            lo_bc[i] = hi_bc[i] = BCType::int_dir;
+        }
+        BCRec bc(lo_bc, hi_bc);
+        desc_lst.setComponent(0, 0, "phi", bc, StateDescriptor::BndryFunc(nullfill));
+    }
+
+    static void variableCleanUp () { desc_lst.clear(); }
+
+    virtual void computeInitialDt (int finest_level, int /*sub_cycle*/, Vector<int>& n_cycle,
+                                   const Vector<IntVect>& /*ref_ratio*/,
+                                   Vector<Real>& dt_level, Real /*stop_time*/) override
+    {
+        if (level > 0) return;
+        dt_level[0] = 1.0;
+        for (int i = 1; i <= finest_level; ++i) {
+            dt_level[i] = dt_level[i-1]/n_cycle[i];
+        }
+    }
+
+    virtual void computeNewDt (int finest_level, int sub_cycle, Vector<int>& n_cycle,
+                               const Vector<IntVect>& ref_ratio, Vector<Real>& /*dt_min*/,
+                               Vector<Real>& dt_level, Real stop_time,
+                               int /*post_regrid_flag*/) override
+    {
+        computeInitialDt(finest_level, sub_cycle, n_cycle, ref_ratio, dt_level, stop_time);
+    }
+
+    virtual Real advance (Real /*time*/, Real dt, int /*iteration*/, int /*ncycle*/) override
+    {
+        for (int k = 0; k < desc_lst.size(); ++k) {
+            state[k].allocOldData();
+            state[k].swapTimeLevels(dt);
+        }
+        MultiFab& S_new = get_new_data(0);
+        MultiFab::Copy(S_new, get_old_data(0), 0, 0, 1, 0);
+        S_new.plus(1.0, 0, 1, 0);
+        return dt;
+    }
+
+    virtual void post_timestep (int /*iteration*/) override {}
+    virtual void post_regrid (int /*lbase*/, int /*new_finest*/) override {}
+    virtual void post_init (Real /*stop_time*/) override {}
+
+    virtual void initData () override
+    {
+        MultiFab& S_new = get_new_data(0);
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            auto const a = S_new.array(mfi);
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        a(i,j,k) = i + 1.e2*j + 1.e4*k + 1.e6*level;
+                    }
+                }
+            }
+        }
+    }
+
+    virtual void init (AmrLevel& old) override
+    {
+        OutLevel* oldlev = (OutLevel*) &old;
+        Real dt_new    = parent->dtLevel(level);
+        Real cur_time  = oldlev->state[0].curTime();
+        Real prev_time = oldlev->state[0].prevTime();
+        setTimeLevel(cur_time, cur_time-prev_time, dt_new);
+        FillPatch(old, get_new_data(0), 0, cur_time, 0, 0, 1);
+    }
+
+    virtual void init () override
+    {
+        Real dt        = parent->dtLevel(level);
+        Real cur_time  = getLevel(level-1).state[0].curTime();
+        Real prev_time = getLevel(level-1).state[0].prevTime();
+        setTimeLevel(cur_time, (cur_time-prev_time)/parent->MaxRefRatio(level-1), dt);
+        FillCoarsePatch(get_new_data(0), 0, cur_time, 0, 0, 1);
+    }
+
+    // Refine the middle half of the domain
+    virtual void errorEst (TagBoxArray& tags, int /*clearval*/, int tagval, Real /*time*/,
+                           int /*n_error_buf*/, int /*ngrow*/) override
+    {
+        const Box& domain = geom.Domain();
+        const Box middle(domain.smallEnd() + domain.length()/4,
+                         domain.bigEnd()   - domain.length()/4);
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox() & middle;
+            if (bx.ok()) {
+                tags[mfi].setVal(static_cast<TagBox::TagType>(tagval), bx);
+            }
+        }
+    }
+
+    OutLevel& getLevel (int lev) { return *(OutLevel*) &parent->getLevel(lev); }
+};
+
+class OutLevelBld
+    :
+    public LevelBld
+{
+    virtual void variableSetUp () override { OutLevel::variableSetUp(); }
+    virtual void variableCleanUp () override { OutLevel::variableCleanUp(); }
+    virtual AmrLevel* operator() () override { return new OutLevel; }
+    virtual AmrLevel* operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new OutLevel(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+OutLevelBld Out_bld;
+
+// The number of values of phi that differ from mf, which is read back
+long ndiff (const MultiFab& phi, const MultiFab& mf)
+{
+    MultiFab tmp(phi.boxArray(), phi.DistributionMap(), 1, 0);
+    tmp.ParallelCopy(mf, 0, 0, 1);
+    MultiFab::Subtract(tmp, phi, 0, 0, 1, 0);
+    long n = 0;
+    for (MFIter mfi(tmp); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        auto const a = tmp.const_array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    if (a(i,j,k) != 0.0) ++n;
+                }
+            }
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(n);
+    return n;
+}
+
+// Whether dir is there and dir.temp is not
+bool renamed (const std::string& dir)
+{
+    int ok = 1;
+    if (ParallelDescriptor::IOProcessor()) {
+        ok = amrex::FileExists(dir) && !amrex::FileExists(dir + ".temp");
+    }
+    ParallelDescriptor::Bcast(&ok, 1, ParallelDescriptor::IOProcessorNumber());
+    return ok;
+}
+
+bool check (const std::string& name, bool ok)
+{
+    amrex::Print() << "  " << name << (ok ? ": ok\n" : ": FAILED\n");
+    return ok;
+}
+
+}
+
+LevelBld*
+getLevelBld ()
+{
+    return &Out_bld;
+}
+
+// Amr calls it before the levels are built; there is nothing to read.
+extern "C" void
+amrex_probinit (const int* /*init*/, const int* /*name*/, const int* /*namelen*/,
+                const amrex_real* /*problo*/, const amrex_real* /*probhi*/)
+{}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        if (!AsyncOut::UseAsyncOut()) {
+            amrex::Abort("This test needs amrex.async_out = 1");
+        }
+
+        int nsteps = 2;
+        {
+            ParmParse pp;
+            pp.query("nsteps", nsteps);
+        }
+
+        Amr amr;
+        amr.init(0.0, 1.e10);
+        for (int step = 0; step < nsteps; ++step) {
+            amr.coarseTimeStep(1.e10);
+        }
+
+        const int nlevels = amr.finestLevel() + 1;
+        const std::string pltfile = amrex::Concatenate("plt", amr.levelSteps(0));
+        const std::string chkfile = amrex::Concatenate("chk", amr.levelSteps(0));
+
+        // Both are staged; keep the data going in the meantime.
+        amr.writePlotFile();
+        amr.checkPoint();
+
+        // WriteMultiLevelPlotfile in the default format, and in one that
+        // WriteAsync cannot write, which falls back to VisMF::Write.
+        Vector<const MultiFab*> phi;
+        Vector<Geometry> geom;
+        Vector<int> level_steps;
+        for (int lev = 0; lev < nlevels; ++lev) {
+            phi.push_back(&amr.getLevel(lev).get_new_data(0));
+            geom.push_back(amr.Geom(lev));
+            level_steps.push_back(amr.levelSteps(lev));
+        }
+        const Vector<std::string> varnames {"phi"};
+        WriteMultiLevelPlotfile("mlplt_async", nlevels, phi, varnames, geom, amr.cumTime(),
+                                level_steps, amr.refRatio());
+        const VisMF::Header::Version version = VisMF::GetHeaderVersion();
+        VisMF::SetHeaderVersion(VisMF::Header::NoFabHeader_v1);
+        WriteMultiLevelPlotfile("mlplt_sync", nlevels, phi, varnames, geom, amr.cumTime(),
+                                level_steps, amr.refRatio());
+        VisMF::SetHeaderVersion(version);
+
+        AsyncOut::Finish();
+        ParallelDescriptor::Barrier();
+
+        bool ok = true;
+        ok = check(pltfile + ".temp renamed", renamed(pltfile)) && ok;
+        ok = check(chkfile + ".temp renamed", renamed(chkfile)) && ok;
+
+        PlotFileData plt(pltfile);
+        PlotFileData mlplt_async("mlplt_async");
+        PlotFileData mlplt_sync("mlplt_sync");
+        for (int lev = 0; lev < nlevels; ++lev) {
+            const std::string l = " level " + std::to_string(lev);
+            ok = check(pltfile + l, ndiff(*phi[lev], plt.get(lev, "phi")) == 0) && ok;
+
+            MultiFab chk;
+            VisMF::Read(chk, chkfile + "/Level_" + std::to_string(lev) + "/SD_0_New_MF");
+            ok = check(chkfile + l, ndiff(*phi[lev], chk) == 0) && ok;
+
+            ok = check("mlplt_async" + l, ndiff(*phi[lev], mlplt_async.get(lev, "phi")) == 0) && ok;
+            ok = check("mlplt_sync" + l, ndiff(*phi[lev], mlplt_sync.get(lev, "phi")) == 0) && ok;
+        }
+
+        if (!ok) amrex::Abort("Asynchronous output failed");
+        amrex::Print() << "  asynchronous output is complete and correct\n";
+    }
+    amrex::Finalize();
+}
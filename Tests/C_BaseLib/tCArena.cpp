@@ -3,10 +3,17 @@
 
 #include <AMReX_REAL.H>
 #include <AMReX_CArena.H>
+#include <AMReX_SArena.H>
 #include <AMReX_Utility.H>
 
 #include <list>
 #include <new>
+#include <vector>
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using std::list;
 
 using namespace amrex;
@@ -64,6 +71,71 @@ FB::ok () const
     return true;
 }
 
+//
+// Every thread repeatedly allocates and frees scratch buffers of random
+// size, the way temporary FABs are used inside MFIter loops.
+//
+double
+churn (Arena& arena, int nsteps, int nlive, std::size_t maxbytes)
+{
+    const double t0 = amrex::second();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+#ifdef _OPENMP
+        unsigned int seed = 12345u + 7919u*omp_get_thread_num();
+#else
+        unsigned int seed = 12345u;
+#endif
+        std::vector<char*> live(nlive, nullptr);
+        for (int step = 0; step < nsteps; ++step)
+        {
+            seed = seed*1103515245u + 12345u;
+            const int slot = (seed >> 8) % nlive;
+            if (live[slot]) {
+                arena.free(live[slot]);
+            }
+            seed = seed*1103515245u + 12345u;
+            const std::size_t nbytes = 8 + (seed >> 4) % maxbytes;
+            live[slot] = static_cast<char*>(arena.alloc(nbytes));
+            live[slot][0] = live[slot][nbytes-1] = 1;
+        }
+        for (auto p : live) {
+            arena.free(p);
+        }
+    }
+    return amrex::second() - t0;
+}
+
+void
+benchmark ()
+{
+#ifdef _OPENMP
+    const int nthreads = omp_get_max_threads();
+#else
+    const int nthreads = 1;
+#endif
+    const int nsteps = 200000;
+    const int nlive  = 64;
+
+    for (std::size_t maxbytes : {std::size_t(4096), std::size_t(256*1024), std::size_t(4*1024*1024)})
+    {
+        double tc, ts;
+        {
+            CArena carena;
+            tc = churn(carena, nsteps, nlive, maxbytes);
+        }
+        {
+            SArena sarena;
+            ts = churn(sarena, nsteps, nlive, maxbytes);
+        }
+        std::cout << "Churn with " << nthreads << " threads, max bytes " << maxbytes
+                  << ": CArena " << tc << " s, SArena " << ts << " s, speedup "
+                  << tc/ts << std::endl;
+    }
+}
+
 int
 main ()
 {
@@ -85,5 +157,7 @@ main ()
         }
     }
 
+    benchmark();
+
     return 0;
 }
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <string>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_AmrCore.H>
+#include <AMReX_TagBox.H>
+
+using namespace amrex;
+
+namespace {
+
+int period = 16;
+
+// Whether cell iv of level 0 is tagged.  The domain is cut into cubes of
+// period cells, and every other one has a block of tags away from its faces.
+bool tagged (const IntVect& iv)
+{
+    const IntVect q = iv / period;
+    const IntVect r = iv - q*period;
+    if ((AMREX_D_TERM(q[0], + q[1], + q[2])) % 2 != 0) return false;
+    const int size = 3 + (AMREX_D_TERM(q[0], + 2*q[1], + 3*q[2])) % 3;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (r[idim] < 4 || r[idim] >= 4 + size) return false;
+    }
+    return true;
+}
+
+// Tags the same cells on any number of processes; there is no data.
+class ClusterTest
+    : public AmrCore
+{
+public:
+
+    explicit ClusterTest (bool distributed) { use_distributed_clustering = distributed; }
+
+protected:
+
+    virtual void ErrorEst (int lev, TagBoxArray& tags, Real /*time*/, int /*ngrow*/) override
+    {
+        if (lev > 0) return;
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            TagBox& tag = tags[mfi];
+            for (BoxIterator bi(bx); bi.ok(); ++bi) {
+                if (tagged(bi())) tag(bi()) = TagBox::SET;
+            }
+        }
+    }
+
+    virtual void MakeNewLevelFromScratch (int /*lev*/, Real /*time*/, const BoxArray& /*ba*/,
+                                          const DistributionMapping& /*dm*/) override {}
+
+    virtual void MakeNewLevelFromCoarse (int /*lev*/, Real /*time*/, const BoxArray& /*ba*/,
+                                         const DistributionMapping& /*dm*/) override {}
+
+    virtual void RemakeLevel (int /*lev*/, Real /*time*/, const BoxArray& /*ba*/,
+                              const DistributionMapping& /*dm*/) override {}
+
+    virtual void ClearLevel (int /*lev*/) override {}
+};
+
+// Whether a and b have the same boxes, in any order
+bool sameBoxes (const BoxArray& a, const BoxArray& b)
+{
+    if (a.size() != b.size()) return false;
+    Vector<Box> va = a.boxList().data();
+    Vector<Box> vb = b.boxList().data();
+    std::sort(va.begin(), va.end());
+    std::sort(vb.begin(), vb.end());
+    return va == vb;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        {
+            ParmParse pp;
+            pp.query("period", period);
+        }
+
+        ClusterTest serial(false);
+        serial.InitFromScratch(0.0);
+
+        ClusterTest distributed(true);
+        distributed.InitFromScratch(0.0);
+
+        bool ok = serial.finestLevel() == distributed.finestLevel() && serial.finestLevel() > 0;
+        amrex::Print() << "  finest level: serial " << serial.finestLevel()
+                       << ", distributed " << distributed.finestLevel() << "\n";
+        for (int lev = 1; ok && lev <= serial.finestLevel(); ++lev) {
+            const BoxArray& ba = serial.boxArray(lev);
+            const BoxArray& dba = distributed.boxArray(lev);
+            const bool same = sameBoxes(ba, dba);
+            amrex::Print() << "  level " << lev << ": serial " << ba.size() << " boxes, "
+                           << ba.numPts() << " cells; distributed " << dba.size() << " boxes, "
+                           << dba.numPts() << " cells" << (same ? ": same\n" : ": DIFFERENT\n");
+            ok = same && ok;
+        }
+
+        if (!ok) amrex::Abort("Distributed clustering differs from serial clustering");
+    }
+    amrex::Finalize();
+}
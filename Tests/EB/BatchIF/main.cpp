@@ -0,0 +1,156 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace amrex;
+
+namespace {
+
+struct Points
+{
+    std::vector<Real> x, y, z;
+};
+
+Points makePoints (int npts)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<Real> dist(-0.6, 0.6);
+    Points p;
+    p.x.resize(npts);
+    p.y.resize(npts);
+    p.z.resize(npts);
+    for (int i = 0; i < npts; ++i) {
+        p.x[i] = dist(gen);
+        p.y[i] = dist(gen);
+        p.z[i] = dist(gen);
+    }
+    return p;
+}
+
+//
+// Evaluate f at the points one at a time and in batches.  The results
+// must be the same to the last bit.  Returns false if they are not.
+//
+template <class F>
+bool checkBatch (const std::string& name, F const& f, const Points& p, int nrep)
+{
+    const int npts = p.x.size();
+    std::vector<Real> vs(npts), vb(npts);
+
+    Real ts = amrex::second();
+    for (int rep = 0; rep < nrep; ++rep) {
+        for (int i = 0; i < npts; ++i) {
+            vs[i] = EB2::IF_f(f, {p.x[i], p.y[i], p.z[i]});
+        }
+    }
+    ts = amrex::second() - ts;
+
+    Real tb = amrex::second();
+    for (int rep = 0; rep < nrep; ++rep) {
+        EB2::evalBatch(f, npts, p.x.data(), p.y.data(), p.z.data(), vb.data());
+    }
+    tb = amrex::second() - tb;
+
+    const bool ok = std::memcmp(vs.data(), vb.data(), npts*sizeof(Real)) == 0;
+
+    amrex::Print() << "  " << name << std::string(std::max(1,24-int(name.size())), ' ')
+                   << "scalar " << ts << "  batch " << tb
+                   << "  speedup " << ts/tb << (ok ? "" : "  MISMATCH") << "\n";
+    return ok;
+}
+
+EB2::SplineIF makeSpline ()
+{
+    EB2::SplineIF spline;
+    std::vector<RealVect> pts;
+    pts.push_back(RealVect(0.40,  0.10, 0.0));
+    pts.push_back(RealVect(0.35,  0.05, 0.0));
+    pts.push_back(RealVect(0.30,  0.00, 0.0));
+    pts.push_back(RealVect(0.25, -0.10, 0.0));
+    pts.push_back(RealVect(0.20, -0.20, 0.0));
+    spline.addSplineElement(pts);
+    pts.clear();
+    pts.push_back(RealVect(0.20, -0.20, 0.0));
+    pts.push_back(RealVect(0.00, -0.20, 0.0));
+    spline.addLineElement(pts);
+    return spline;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int npts = 100003;
+        int nrep = 20;
+        {
+            ParmParse pp;
+            pp.query("npts", npts);
+            pp.query("nrep", nrep);
+        }
+
+        EB2::SphereIF sphere(0.5, {0.0,0.0,0.0}, false);
+        EB2::BoxIF cube({-0.4,-0.4,-0.4}, {0.4,0.4,0.4}, false);
+        EB2::CylinderIF cylinder_x(0.25, 0, {0.0,0.0,0.0}, false);
+        EB2::CylinderIF cylinder_y(0.25, 1, {0.0,0.0,0.0}, false);
+        EB2::CylinderIF cylinder_z(0.25, 2, {0.0,0.0,0.0}, false);
+        EB2::PlaneIF plane({0.1,0.0,0.0}, {1.0,0.3,-0.2});
+        EB2::EllipsoidIF ellipsoid({0.3,0.2,0.4}, {0.0,0.1,0.0}, true);
+        EB2::TorusIF torus(0.3, 0.1, {0.0,0.0,0.1}, false);
+
+        // Tutorials/EB/GeometryGeneration, which_geom = 0
+        auto csg = EB2::makeDifference(EB2::makeIntersection(sphere, cube),
+                                       EB2::makeUnion(cylinder_x, cylinder_y, cylinder_z));
+
+        // Tutorials/EB/CNS, the combustor scaled down to the unit cube
+        auto combustor = EB2::translate
+            (EB2::lathe(EB2::makeUnion(EB2::PlaneIF({0.45,0.,0.}, {1.,0.,0.}),
+                                       EB2::makeIntersection(EB2::PlaneIF({0.25,0.75,0.}, {0.,-1.,0.}),
+                                                             EB2::PlaneIF({0.25,0.75,0.}, {3.45,-0.95,0.}),
+                                                             EB2::PlaneIF({0.1,0.,0.}, {1.,0.,0.})),
+                                       EB2::BoxIF({0.06,-1.,-1.}, {0.1,0.5,1.}, false),
+                                       EB2::BoxIF({0.1,0.,-1.}, {1.e10,0.35,1.}, false))),
+             {-0.5,-0.5,-0.5});
+
+        // Tutorials/EB/GeometryGeneration, which_geom = 1, with a shorter spline
+        auto piston = EB2::makeIntersection(EB2::makeComplement(EB2::lathe(makeSpline())),
+                                            EB2::CylinderIF(0.45, 0.8, 2, {0.0,0.0,0.0}, false));
+
+        const Points p = makePoints(npts);
+
+        amrex::Print() << "Evaluating at " << npts << " points " << nrep << " times\n";
+        bool ok = true;
+        ok = checkBatch("sphere", sphere, p, nrep) && ok;
+        ok = checkBatch("box", cube, p, nrep) && ok;
+        ok = checkBatch("cylinder", cylinder_x, p, nrep) && ok;
+        ok = checkBatch("plane", plane, p, nrep) && ok;
+        ok = checkBatch("ellipsoid", ellipsoid, p, nrep) && ok;
+        ok = checkBatch("torus", torus, p, nrep) && ok;
+        ok = checkBatch("union", EB2::makeUnion(sphere, cylinder_y, plane), p, nrep) && ok;
+        ok = checkBatch("intersection", EB2::makeIntersection(torus, cube), p, nrep) && ok;
+        ok = checkBatch("complement", EB2::makeComplement(ellipsoid), p, nrep) && ok;
+        ok = checkBatch("translate", EB2::translate(torus, {0.1,-0.2,0.05}), p, nrep) && ok;
+        ok = checkBatch("scale", EB2::scale(ellipsoid, {1.5,0.5,2.0}), p, nrep) && ok;
+        for (int dir = 0; dir < 3; ++dir) {
+            ok = checkBatch("rotate "+std::to_string(dir), EB2::rotate(cube, 0.3, dir), p, nrep) && ok;
+        }
+        for (int dir = 0; dir < 3; ++dir) {
+            ok = checkBatch("extrude "+std::to_string(dir), EB2::extrude(torus, dir), p, nrep) && ok;
+        }
+        ok = checkBatch("lathe", EB2::lathe(cylinder_y), p, nrep) && ok;
+        ok = checkBatch("csg", csg, p, nrep) && ok;
+        ok = checkBatch("combustor", combustor, p, nrep) && ok;
+        ok = checkBatch("spline piston", piston, p, nrep) && ok;
+
+        if (!ok) amrex::Abort("EB2::evalBatch does not agree with scalar evaluation");
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,209 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+namespace {
+
+// All the geometric data of an EB2::Level, filled on our own boxes with ghost cells.
+struct LevelData
+{
+    FabArray<EBCellFlagFab> flag;
+    MultiFab vfrac, cent, barea, bcent, bnorm;
+    Array<MultiFab,AMREX_SPACEDIM> apf, fcent;
+
+    LevelData (const EB2::Level& eblev, const Geometry& geom,
+               const BoxArray& ba, const DistributionMapping& dm)
+    {
+        const int ng = 2;
+        flag.define(ba, dm, 1, ng);
+        vfrac.define(ba, dm, 1, ng);
+        cent.define(ba, dm, AMREX_SPACEDIM, ng);
+        barea.define(ba, dm, 1, ng);
+        bcent.define(ba, dm, AMREX_SPACEDIM, ng);
+        bnorm.define(ba, dm, AMREX_SPACEDIM, ng);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            const BoxArray& fba = amrex::convert(ba, IntVect::TheDimensionVector(idim));
+            apf[idim].define(fba, dm, 1, ng);
+            fcent[idim].define(fba, dm, AMREX_SPACEDIM-1, ng);
+        }
+
+        eblev.fillEBCellFlag(flag, geom);
+        eblev.fillVolFrac(vfrac, geom);
+        eblev.fillCentroid(cent, geom);
+        eblev.fillBndryArea(barea, geom);
+        eblev.fillBndryCent(bcent, geom);
+        eblev.fillBndryNorm(bnorm, geom);
+        eblev.fillAreaFrac(amrex::GetArrOfPtrs(apf), geom);
+        eblev.fillFaceCent(amrex::GetArrOfPtrs(fcent), geom);
+    }
+};
+
+// Largest difference between two MultiFabs, ghost cells included.
+Real maxDiff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), a.nGrow());
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), a.nGrow());
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), a.nGrow());
+    Real r = 0.0;
+    for (int n = 0; n < a.nComp(); ++n) {
+        r = std::max(r, d.norm0(n, a.nGrow()));
+    }
+    return r;
+}
+
+// Largest difference between all the data, 1 if the flags differ.
+Real maxDiff (const LevelData& a, const LevelData& b)
+{
+    Real r = std::max({maxDiff(a.vfrac, b.vfrac), maxDiff(a.cent, b.cent),
+                       maxDiff(a.barea, b.barea), maxDiff(a.bcent, b.bcent),
+                       maxDiff(a.bnorm, b.bnorm)});
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        r = std::max({r, maxDiff(a.apf[idim], b.apf[idim]),
+                      maxDiff(a.fcent[idim], b.fcent[idim])});
+    }
+    for (MFIter mfi(a.flag); mfi.isValid(); ++mfi) {
+        const auto& af = a.flag[mfi];
+        const auto& bf = b.flag[mfi];
+        for (BoxIterator bit(mfi.fabbox()); bit.ok(); ++bit) {
+            if (af(bit()) != bf(bit())) r = 1.0;
+        }
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+void buildEB (const Geometry& geom, int max_coarsening_level, Real radius = 0.3)
+{
+    EB2::SphereIF sphere(radius, {AMREX_D_DECL(0.45, 0.5, 0.55)}, false);
+    EB2::BoxIF box({AMREX_D_DECL(0.25,0.5,0.5)}, {AMREX_D_DECL(0.75,0.9,0.75)}, false);
+    auto gshop = EB2::makeShop(EB2::makeUnion(sphere, box));
+    EB2::Build(gshop, geom, max_coarsening_level, max_coarsening_level);
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 128;
+        int max_grid_size = 32;
+        int max_coarsening_level = 3;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_coarsening_level", max_coarsening_level);
+        }
+
+        // periodic in x so that the periodic shifts of the fill functions are tested
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,0,0)};
+        Geometry geom(Box(IntVect(0), IntVect(n_cell-1)), rb, CoordSys::cartesian, is_periodic);
+
+        // the checkpoint is tested last
+        const std::string chkpt_file = EB2::chkpt_file;
+        EB2::chkpt_file.clear();
+
+        EB2::compress_geometry = false;
+        buildEB(geom, max_coarsening_level);
+        const EB2::IndexSpace& dense_is = EB2::IndexSpace::top();
+
+        EB2::compress_geometry = true;
+        buildEB(geom, max_coarsening_level);
+        const EB2::IndexSpace& sparse_is = EB2::IndexSpace::top();
+
+        for (int lev = 0; lev <= max_coarsening_level; ++lev)
+        {
+            const Geometry& lgeom = dense_is.getGeometry(amrex::coarsen(geom.Domain(), 1<<lev));
+            const EB2::Level& dense_lev = dense_is.getLevel(lgeom);
+            const EB2::Level& sparse_lev = sparse_is.getLevel(lgeom);
+            if (!sparse_lev.isCompressed()) amrex::Abort("EB2::Level was not compressed");
+
+            BoxArray ba(lgeom.Domain());
+            ba.maxSize(max_grid_size);
+            DistributionMapping dm(ba);
+
+            LevelData d(dense_lev, lgeom, ba, dm);
+            LevelData s(sparse_lev, lgeom, ba, dm);
+
+            const Real err = maxDiff(d, s);
+
+            long ncut = 0;
+            for (MFIter mfi(s.flag); mfi.isValid(); ++mfi) {
+                const auto& fab = s.flag[mfi];
+                for (BoxIterator bit(mfi.validbox()); bit.ok(); ++bit) {
+                    if (fab(bit()).isSingleValued()) ++ncut;
+                }
+            }
+            ParallelDescriptor::ReduceLongSum(ncut);
+
+            amrex::Print() << "Level " << lev << ": " << ncut << " cut cells of "
+                           << lgeom.Domain().numPts() << ", max difference "
+                           << err << "\n";
+            if (err != 0.0) amrex::Abort("compressed EB2::Level data differ");
+        }
+        amrex::Print() << "Compressed EB2::Level data agree\n";
+
+        if (chkpt_file.empty()) {
+            amrex::Print() << "eb2.chkpt_file is not set, the checkpoint is not tested\n";
+        } else {
+            // the first Build with a checkpoint file builds and writes it, the second reads it
+            EB2::chkpt_file = chkpt_file;
+            if (ParallelDescriptor::IOProcessor() && amrex::FileExists(chkpt_file)) {
+                amrex::UtilRenameDirectoryToOld(chkpt_file, false);
+            }
+            ParallelDescriptor::Barrier();
+            Real t_write = amrex::second();
+            buildEB(geom, max_coarsening_level);
+            t_write = amrex::second() - t_write;
+            Real t_read = amrex::second();
+            buildEB(geom, max_coarsening_level);
+            t_read = amrex::second() - t_read;
+            const EB2::IndexSpace& read_is = EB2::IndexSpace::top();
+            if (dynamic_cast<const EB2::IndexSpaceChkpt*>(&read_is) == nullptr) {
+                amrex::Abort("EB2::Build did not read the checkpoint");
+            }
+
+            for (int lev = 0; lev <= max_coarsening_level; ++lev)
+            {
+                const Geometry& lgeom = dense_is.getGeometry(amrex::coarsen(geom.Domain(), 1<<lev));
+                BoxArray ba(lgeom.Domain());
+                ba.maxSize(max_grid_size);
+                DistributionMapping dm(ba);
+
+                LevelData d(dense_is.getLevel(lgeom), lgeom, ba, dm);
+                LevelData r(read_is.getLevel(lgeom), lgeom, ba, dm);
+                const Real err = maxDiff(d, r);
+
+                amrex::Print() << "Level " << lev << " from checkpoint: max difference " << err << "\n";
+                if (err != 0.0) amrex::Abort("EB2::Level read from checkpoint differs");
+            }
+
+            // a different geometry must not be read from the checkpoint
+            buildEB(geom, max_coarsening_level, 0.31);
+            if (dynamic_cast<const EB2::IndexSpaceChkpt*>(&EB2::IndexSpace::top()) != nullptr) {
+                amrex::Abort("EB2::Build read the checkpoint of another geometry");
+            }
+
+            // nor the same geometry under another key
+            buildEB(geom, max_coarsening_level);
+            EB2::chkpt_key += "_v2";
+            buildEB(geom, max_coarsening_level);
+            if (dynamic_cast<const EB2::IndexSpaceChkpt*>(&EB2::IndexSpace::top()) != nullptr) {
+                amrex::Abort("EB2::Build read the checkpoint of another eb2.chkpt_key");
+            }
+
+            ParallelDescriptor::ReduceRealMax(t_write);
+            ParallelDescriptor::ReduceRealMax(t_read);
+            amrex::Print() << "Build and write time : " << t_write << "\n"
+                           << "Read time            : " << t_read << "\n";
+        }
+    }
+    amrex::Finalize();
+}
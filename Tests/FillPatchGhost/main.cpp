@@ -0,0 +1,164 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_FillPatchUtil.H>
+#include <AMReX_Interpolater.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+// A smooth periodic function, whose value changes with time
+void fillState (MultiFab& mf, const Geometry& geom, Real time)
+{
+    const Real* dx = geom.CellSize();
+    const Real twopi = 2.0*3.14159265358979323846;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        auto const a = mf.array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for (int n = 0; n < mf.nComp(); ++n) {
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    const Real x = (i+0.5)*dx[0];
+                    const Real y = (AMREX_SPACEDIM > 1) ? (j+0.5)*dx[1] : 0.0;
+                    const Real z = (AMREX_SPACEDIM > 2) ? (k+0.5)*dx[2] : 0.0;
+                    a(i,j,k,n) = std::sin(twopi*(x+0.1*n)) * std::cos(twopi*y) * std::cos(twopi*z)
+                        + time*std::cos(twopi*x);
+                }
+            }
+        }
+        }
+    }
+}
+
+Real maxDiff (const MultiFab& a, const MultiFab& b, int ncomp, int nghost)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), ncomp, nghost);
+    MultiFab::Copy(d, a, 0, 0, ncomp, nghost);
+    MultiFab::Subtract(d, b, 0, 0, ncomp, nghost);
+    Real r = 0.0;
+    for (int n = 0; n < ncomp; ++n) {
+        r = std::max(r, d.norm0(n, nghost));
+    }
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 32;
+        int nghost = 2;
+        int ncomp = 2;
+        int nrep = 10;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nghost", nghost);
+            pp.query("ncomp", ncomp);
+            pp.query("nrep", nrep);
+        }
+
+        const IntVect ratio(2);
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1,1,1)};
+        const Box cdomain(IntVect(0), IntVect(n_cell-1));
+        Geometry cgeom(cdomain, rb, 0, is_periodic);
+        Geometry fgeom(amrex::refine(cdomain,ratio), rb, 0, is_periodic);
+
+        BoxArray cba(cdomain);
+        cba.maxSize(max_grid_size);
+        DistributionMapping cdm(cba);
+
+        // Two fine patches at the low and high x ends of the domain, so that
+        // some fine ghost cells are covered by the periodic image of the
+        // other patch.
+        const int q = n_cell/4;
+        BoxList fbl;
+        fbl.push_back(Box(IntVect(AMREX_D_DECL(0,q,q)),
+                          IntVect(AMREX_D_DECL(q-1,3*q-1,3*q-1))));
+        fbl.push_back(Box(IntVect(AMREX_D_DECL(3*q,q,q)),
+                          IntVect(AMREX_D_DECL(n_cell-1,3*q-1,3*q-1))));
+        BoxArray fba(fbl);
+        fba.refine(ratio);
+        fba.maxSize(max_grid_size);
+        DistributionMapping fdm(fba);
+
+        const Real ct0 = 0.0, ct1 = 1.0;
+        MultiFab c0(cba, cdm, ncomp, 0), c1(cba, cdm, ncomp, 0);
+        fillState(c0, cgeom, ct0);
+        fillState(c1, cgeom, ct1);
+        const Vector<MultiFab*> cmf{&c0, &c1};
+        const Vector<Real> ct{ct0, ct1};
+
+        PhysBCFunctNoOp bc;
+        Vector<BCRec> bcs(ncomp, BCRec(AMREX_D_DECL(BCType::int_dir,BCType::int_dir,BCType::int_dir),
+                                       AMREX_D_DECL(BCType::int_dir,BCType::int_dir,BCType::int_dir)));
+
+        bool ok = true;
+        for (Real time : {ct0, 0.5*(ct0+ct1)})
+        {
+            MultiFab fine(fba, fdm, ncomp, 0);
+            fillState(fine, fgeom, time);
+
+            MultiFab ref(fba, fdm, ncomp, nghost);
+            ref.setVal(0.0);
+            Vector<Real> t(3, 0.0);
+            for (int rep = 0; rep < nrep; ++rep) {
+                ParallelDescriptor::Barrier();
+                Real t0 = amrex::second();
+                FillPatchTwoLevels(ref, time, cmf, ct, {&fine}, {time}, 0, 0, ncomp,
+                                   cgeom, fgeom, bc, 0, bc, 0, ratio, &cell_cons_interp, bcs, 0);
+                t[0] += amrex::second() - t0;
+            }
+
+            // The time interpolation done on the whole coarse level
+            {
+                MultiFab cmid(cba, cdm, ncomp, 0);
+                const Real alpha = (ct1-time)/(ct1-ct0), beta = (time-ct0)/(ct1-ct0);
+                MultiFab::LinComb(cmid, alpha, c0, 0, beta, c1, 0, 0, ncomp, 0);
+                MultiFab ref2(fba, fdm, ncomp, nghost);
+                ref2.setVal(0.0);
+                FillPatchTwoLevels(ref2, time, {&cmid}, {time}, {&fine}, {time}, 0, 0, ncomp,
+                                   cgeom, fgeom, bc, 0, bc, 0, ratio, &cell_cons_interp, bcs, 0);
+                ok = ok && maxDiff(ref2, ref, ncomp, nghost) == 0.0;
+            }
+
+            MultiFab ghost(fba, fdm, ncomp, nghost);
+            for (int use_cache = 0; use_cache < 2; ++use_cache)
+            {
+                FillPatchCrseCache cache;
+                for (int rep = 0; rep < nrep; ++rep) {
+                    ghost.setVal(0.0);
+                    MultiFab::Copy(ghost, fine, 0, 0, ncomp, 0);
+                    ParallelDescriptor::Barrier();
+                    Real t0 = amrex::second();
+                    FillPatchGhostTwoLevels(ghost, time, cmf, ct, 0, 0, ncomp,
+                                            cgeom, fgeom, bc, 0, bc, 0, ratio, &cell_cons_interp,
+                                            bcs, 0, use_cache ? &cache : nullptr);
+                    t[1+use_cache] += amrex::second() - t0;
+                }
+                const Real diff = maxDiff(ghost, ref, ncomp, nghost);
+                ok = ok && diff == 0.0 && cache.numHits() == (use_cache ? nrep-1 : 0);
+            }
+
+            ParallelDescriptor::ReduceRealMax(t.dataPtr(), 3);
+            amrex::Print() << "  time " << time << ": FillPatchTwoLevels " << t[0]/nrep
+                           << ", FillPatchGhostTwoLevels " << t[1]/nrep
+                           << ", with cache " << t[2]/nrep << "\n";
+        }
+
+        if (!ok) amrex::Abort("FillPatchGhostTwoLevels does not agree with FillPatchTwoLevels");
+        amrex::Print() << "  FillPatchGhostTwoLevels agrees with FillPatchTwoLevels\n";
+    }
+    amrex::Finalize();
+}
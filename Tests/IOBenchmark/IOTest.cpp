@@ -252,6 +252,9 @@ void TestWriteNFiles(int nfiles, int maxgrid, int ncomps, int nboxes,
     case VisMF::Header::NoFabHeaderFAMinMax_v1:
       mfName = "TestMFNoFabHeaderFAMinMax";
     break;
+    case VisMF::Header::Compressed_v1:
+      mfName = "TestMFCompressed";
+    break;
     default:
       amrex::Abort("**** Error in TestWriteNFiles:  bad version.");
   }
@@ -1,9 +1,13 @@
 #include <AMReX_MultiFab.H>
 #include <AMReX_MLMG.H>
 #include <AMReX_MLABecLaplacian.H>
+#include <AMReX_MLPoisson.H>
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_ParmParse.H>
 
+#include <iomanip>
+#include <map>
+
 #include <prob_par.H>
 
 using namespace amrex;
@@ -20,6 +24,80 @@ static int linop_maxorder = 2;
 static bool agglomeration = false;
 static bool consolidation = false;
 static int  use_hypre = 0;
+static std::string bottom_solver;
+static int  sstep = 4;
+static Vector<std::string> compare_bottom_solvers;
+static Real compare_bottom_tol = 1.e-6;
+static bool compare_mixed_precision = false;
+
+MLMG::BottomSolver bottomSolverFromString (const std::string& s)
+{
+    if (s == "smoother") {
+        return MLMG::BottomSolver::smoother;
+    } else if (s == "bicgstab") {
+        return MLMG::BottomSolver::bicgstab;
+    } else if (s == "cg") {
+        return MLMG::BottomSolver::cg;
+    } else if (s == "bicgcg") {
+        return MLMG::BottomSolver::bicgcg;
+    } else if (s == "cgbicg") {
+        return MLMG::BottomSolver::cgbicg;
+    } else if (s == "hypre") {
+        return MLMG::BottomSolver::hypre;
+    } else if (s == "pipebicgstab") {
+        return MLMG::BottomSolver::pipebicgstab;
+    } else if (s == "pipecg") {
+        return MLMG::BottomSolver::pipecg;
+    } else if (s == "sstepcg") {
+        return MLMG::BottomSolver::sstepcg;
+    } else {
+        amrex::Abort("Unknown bottom_solver: " + s);
+        return MLMG::BottomSolver::Default;
+    }
+}
+
+// Solve the Poisson equation on level 0 with double precision V-cycles and
+// with single precision V-cycles inside double precision iterative refinement.
+void compare_mixed_precision_solves (const Geometry& geom, MultiFab& soln, const MultiFab& rhs,
+                                     const LPInfo& info, Real tol_rel, Real tol_abs)
+{
+    MultiFab soln_double(soln.boxArray(), soln.DistributionMap(), 1, 1);
+
+    for (int mixed = 0; mixed <= 1; ++mixed)
+    {
+        MLPoisson mlpoisson({geom}, {soln.boxArray()}, {soln.DistributionMap()}, info);
+        mlpoisson.setMaxOrder(linop_maxorder);
+        mlpoisson.setDomainBC({prob::bc_type, prob::bc_type, prob::bc_type},
+                              {prob::bc_type, prob::bc_type, prob::bc_type});
+        soln.setVal(0.0);
+        mlpoisson.setLevelBC(0, &soln);
+
+        MLMG mlmg(mlpoisson);
+        mlmg.setMaxIter(max_iter);
+        mlmg.setVerbose(verbose);
+        mlmg.setBottomVerbose(cg_verbose);
+        mlmg.setMixedPrecision(mixed);
+
+        const Real t0 = amrex::second();
+        const Real resid = mlmg.solve({&soln}, {&rhs}, tol_rel, tol_abs);
+        Real t = amrex::second() - t0;
+        ParallelDescriptor::ReduceRealMax(t);
+
+        amrex::Print() << (mixed ? "Mixed  precision" : "Double precision")
+                       << ": iterations = " << std::setw(3) << mlmg.getNumIters()
+                       << ", final residual = " << resid
+                       << ", solve time = " << t << "\n";
+
+        if (mixed) {
+            MultiFab::Subtract(soln_double, soln, 0, 0, 1, 0);
+            amrex::Print() << "Max difference between the solutions = "
+                           << soln_double.norminf(0, 0) << " (max |soln| = "
+                           << soln.norminf(0, 0) << ")\n";
+        } else {
+            MultiFab::Copy(soln_double, soln, 0, 0, 1, 0);
+        }
+    }
+}
 }
 
 void solve_with_mlmg(const Vector<Geometry>& geom, int ref_ratio,
@@ -44,6 +122,11 @@ void solve_with_mlmg(const Vector<Geometry>& geom, int ref_ratio,
     pp.query("agglomeration", agglomeration);
     pp.query("consolidation", consolidation);
     pp.query("use_hypre", use_hypre);
+    pp.query("bottom_solver", bottom_solver);
+    pp.query("sstep", sstep);
+    pp.queryarr("compare_bottom_solvers", compare_bottom_solvers);
+    pp.query("compare_bottom_tol", compare_bottom_tol);
+    pp.query("compare_mixed_precision", compare_mixed_precision);
     pp.query("tol_rel", tol_rel);
     pp.query("tol_abs", tol_abs);
   }
@@ -55,6 +138,14 @@ void solve_with_mlmg(const Vector<Geometry>& geom, int ref_ratio,
 
   const int nlevels = geom.size();
 
+  if (compare_mixed_precision) {
+    compare_mixed_precision_solves(geom[0], soln[0], rhs[0], info, tol_rel, tol_abs);
+    for (int ilev = 1; ilev < nlevels; ++ilev) {
+      soln[ilev].setVal(0.0);
+    }
+    return;
+  }
+
   if (composite_solve) {
     Vector<BoxArray> grids;
     Vector<DistributionMapping> dmap;
@@ -93,10 +184,79 @@ void solve_with_mlmg(const Vector<Geometry>& geom, int ref_ratio,
     mlmg.setMaxIter(max_iter);
     mlmg.setMaxFmgIter(max_fmg_iter);
     if (use_hypre) mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
+    if (!bottom_solver.empty()) mlmg.setBottomSolver(bottomSolverFromString(bottom_solver));
+    mlmg.setBottomSStep(sstep);
     mlmg.setVerbose(verbose);
     mlmg.setBottomVerbose(cg_verbose);
 
-    mlmg.solve(psoln, prhs, tol_rel, tol_abs);
+    if (compare_bottom_solvers.empty()) {
+      mlmg.solve(psoln, prhs, tol_rel, tol_abs);
+    } else {
+      // Solve the same problem once per bottom solver, from a zero initial
+      // guess.  A pipelined or s-step solver must converge in about the
+      // iterations of the classic solver it reformulates, to a residual
+      // and a solution within compare_bottom_tol of it.
+      const std::map<std::string,std::string> classic {{"pipebicgstab", "bicgstab"},
+                                                       {"pipecg", "cg"},
+                                                       {"sstepcg", "cg"}};
+      struct Result {
+        int iters, bottom_iters;
+        Real resid;
+        Vector<MultiFab> soln;
+      };
+      std::map<std::string,Result> results;
+      bool ok = true;
+      for (const auto& name : compare_bottom_solvers) {
+        for (auto& mf : soln) {
+          mf.setVal(0.0);
+        }
+        mlmg.setBottomSolver(bottomSolverFromString(name));
+        const Real t0 = amrex::second();
+        const Real resid = mlmg.solve(psoln, prhs, tol_rel, tol_abs);
+        Real times[2] = { amrex::second() - t0, mlmg.getBottomSolveTime() };
+        ParallelDescriptor::ReduceRealMax(times, 2, ParallelDescriptor::IOProcessorNumber());
+        amrex::Print() << "Bottom solver " << std::setw(12) << name
+                       << ": iterations = " << std::setw(3) << mlmg.getNumIters()
+                       << ", bottom iterations = " << std::setw(6) << mlmg.getNumBottomIters()
+                       << ", final residual = " << resid
+                       << ", bottom time = " << times[1]
+                       << ", solve time = " << times[0] << "\n";
+
+        Result& r = results[name];
+        r.iters = mlmg.getNumIters();
+        r.bottom_iters = mlmg.getNumBottomIters();
+        r.resid = resid;
+        r.soln.resize(nlevels);
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+          r.soln[ilev].define(soln[ilev].boxArray(), soln[ilev].DistributionMap(), 1, 0);
+          MultiFab::Copy(r.soln[ilev], soln[ilev], 0, 0, 1, 0);
+        }
+
+        const auto it = classic.find(name);
+        if (it == classic.end() || results.count(it->second) == 0) continue;
+        const Result& c = results[it->second];
+
+        Real diff = 0.0, solmax = 0.0;
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+          MultiFab::Subtract(r.soln[ilev], c.soln[ilev], 0, 0, 1, 0);
+          diff = std::max(diff, r.soln[ilev].norminf(0, 0));
+          solmax = std::max(solmax, c.soln[ilev].norminf(0, 0));
+          MultiFab::Add(r.soln[ilev], c.soln[ilev], 0, 0, 1, 0);
+        }
+
+        const bool iters_ok = r.iters <= c.iters + 1 && r.bottom_iters <= 2*c.bottom_iters;
+        const bool resid_ok = std::abs(r.resid - c.resid) <= compare_bottom_tol * c.resid;
+        const bool soln_ok = diff <= compare_bottom_tol * solmax;
+        amrex::Print() << "  against " << it->second << ": iterations "
+                       << (iters_ok ? "ok" : "FAILED") << ", residual "
+                       << (resid_ok ? "ok" : "FAILED") << ", max solution difference "
+                       << diff << (soln_ok ? "\n" : " FAILED\n");
+        ok = ok && iters_ok && resid_ok && soln_ok;
+      }
+      if (!ok) {
+        amrex::Abort("A pipelined or s-step bottom solver does not agree with the classic one");
+      }
+    }
   } else {
     const int levbegin = (fine_leve_solve_only) ? nlevels-1 : 0;
     for (int ilev = 0; ilev < levbegin; ++ilev) {
@@ -0,0 +1,425 @@
+#include <cmath>
+#include <string>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_AmrCore.H>
+#include <AMReX_TagBox.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_FluxRegister.H>
+#include <AMReX_PROB_AMR_F.H>
+
+using namespace amrex;
+
+namespace {
+
+int heavy = 8;
+
+// The largest correction left in a FluxRegister by a coarse step
+Real max_mismatch = 0.0;
+
+Real phiExact (int i, int j, int k, int lev)
+{
+    return i + 1.e2*j + 1.e4*k + 1.e6*lev;
+}
+
+// Adds one to mf, after some work on a copy of it that is more expensive
+// in the boxes of the low corner of the domain
+void advancePhi (MultiFab& mf, const Box& domain)
+{
+    const IntVect heavy_end = domain.length()/2;
+    FArrayBox tmp;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        auto const a = mf.array(mfi);
+        tmp.resize(bx, 1);
+        auto const t = tmp.array();
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    t(i,j,k) = a(i,j,k);
+                }
+            }
+        }
+        const int nsweeps = (bx.smallEnd() < heavy_end) ? 2*heavy : 2;
+        for (int s = 0; s < nsweeps; ++s) {
+            const Real f = (s%2 == 0) ? 1.0001 : 1.0/1.0001;
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        t(i,j,k) = std::sqrt(t(i,j,k)*t(i,j,k)*f);
+                    }
+                }
+            }
+        }
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    a(i,j,k) += 1.0;
+                }
+            }
+        }
+    }
+}
+
+void initPhi (MultiFab& mf, int lev)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        auto const a = mf.array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    a(i,j,k) = phiExact(i,j,k,lev);
+                }
+            }
+        }
+    }
+}
+
+// Whether mf is what nsteps calls of advancePhi make of initPhi
+bool checkPhi (const MultiFab& mf, int lev, int nsteps)
+{
+    bool ok = true;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        auto const a = mf.const_array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    ok = ok && a(i,j,k) == phiExact(i,j,k,lev) + nsteps;
+                }
+            }
+        }
+    }
+    ParallelDescriptor::ReduceBoolAnd(ok);
+    return ok;
+}
+
+// A single level AmrCore, remapped with LoadBalanceMeasuredCost
+class CostTest
+    : public AmrCore
+{
+public:
+
+    CostTest (const RealBox& rb, const Vector<int>& n_cell)
+        : AmrCore(rb, 0, n_cell, 0, Vector<IntVect>(), {AMREX_D_DECL(1,1,1)}),
+          phi(1)
+        {}
+
+    void advance () { advancePhi(*phi[0], Geom(0).Domain()); }
+
+    bool check (int nsteps) const { return checkPhi(*phi[0], 0, nsteps); }
+
+protected:
+
+    virtual void ErrorEst (int lev, TagBoxArray& tags, Real time, int ngrow) override {}
+
+    virtual void MakeNewLevelFromScratch (int lev, Real time, const BoxArray& ba,
+                                          const DistributionMapping& dm) override
+    {
+        phi[lev].reset(new MultiFab(ba, dm, 1, 0));
+        initPhi(*phi[lev], lev);
+    }
+
+    virtual void MakeNewLevelFromCoarse (int lev, Real time, const BoxArray& ba,
+                                         const DistributionMapping& dm) override
+    {
+        amrex::Abort("CostTest has a single level");
+    }
+
+    virtual void RemakeLevel (int lev, Real time, const BoxArray& ba,
+                              const DistributionMapping& dm) override
+    {
+        std::unique_ptr<MultiFab> mf(new MultiFab(ba, dm, 1, 0));
+        mf->ParallelCopy(*phi[lev]);
+        phi[lev] = std::move(mf);
+    }
+
+    virtual void ClearLevel (int lev) override { phi[lev].reset(); }
+
+private:
+    Vector<std::unique_ptr<MultiFab> > phi;
+};
+
+// Never called, the domain is periodic.
+void nullfill (Box const& /*bx*/, FArrayBox& /*data*/, const int /*dcomp*/,
+               const int /*numcomp*/, Geometry const& /*geom*/, const Real /*time*/,
+               const Vector<BCRec>& /*bcr*/, const int /*bcomp*/, const int /*scomp*/)
+{}
+
+// Levels of an Amr with one state, phi, that advancePhi updates.  Each
+// level above 0 has a FluxRegister, whose coarse and fine fluxes cancel
+// at the end of a coarse step unless the register has been rebuilt in
+// between.
+class CostLevel
+    :
+    public AmrLevel
+{
+public:
+
+    CostLevel () {}
+
+    CostLevel (Amr& papa, int lev, const Geometry& level_geom, const BoxArray& bl,
+               const DistributionMapping& dm, Real time)
+        : AmrLevel(papa, lev, level_geom, bl, dm, time)
+    {
+        if (level > 0) {
+            flux_reg.reset(new FluxRegister(grids, dmap, crse_ratio, level, 1));
+            flux_reg->setVal(0.0);
+        }
+    }
+
+    static void variableSetUp ()
+    {
+        desc_lst.addDescriptor(0, IndexType::TheCellType(), StateDescriptor::Point,
+                               0, 1, &cell_cons_interp);
+        int lo_bc[BL_SPACEDIM], hi_bc[BL_SPACEDIM];
+        for (int i = 0; i < BL_SPACEDIM; ++i) {
+            lo_bc[i] = hi_bc[i] = BCType::int_dir;
+        }
+        BCRec bc(lo_bc, hi_bc);
+        desc_lst.setComponent(0, 0, "phi", bc, StateDescriptor::BndryFunc(nullfill));
+    }
+
+    static void variableCleanUp () { desc_lst.clear(); }
+
+    virtual void computeInitialDt (int finest_level, int /*sub_cycle*/, Vector<int>& n_cycle,
+                                   const Vector<IntVect>& /*ref_ratio*/,
+                                   Vector<Real>& dt_level, Real /*stop_time*/) override
+    {
+        if (level > 0) return;
+        dt_level[0] = 1.0;
+        for (int i = 1; i <= finest_level; ++i) {
+            dt_level[i] = dt_level[i-1]/n_cycle[i];
+        }
+    }
+
+    virtual void computeNewDt (int finest_level, int sub_cycle, Vector<int>& n_cycle,
+                               const Vector<IntVect>& ref_ratio, Vector<Real>& /*dt_min*/,
+                               Vector<Real>& dt_level, Real stop_time,
+                               int /*post_regrid_flag*/) override
+    {
+        computeInitialDt(finest_level, sub_cycle, n_cycle, ref_ratio, dt_level, stop_time);
+    }
+
+    virtual Real advance (Real /*time*/, Real dt, int /*iteration*/, int ncycle) override
+    {
+        for (int k = 0; k < desc_lst.size(); ++k) {
+            state[k].allocOldData();
+            state[k].swapTimeLevels(dt);
+        }
+        MultiFab& S_new = get_new_data(0);
+        MultiFab::Copy(S_new, get_old_data(0), 0, 0, 1, 0);
+
+        advancePhi(S_new, geom.Domain());
+
+        // A unit flux through every face; the fine faces of a coarse face
+        // add up to one over a coarse step.
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            MultiFab flux(amrex::convert(grids, IntVect::TheDimensionVector(dir)), dmap, 1, 0);
+            flux.setVal(1.0);
+            if (level < parent->finestLevel()) {
+                getLevel(level+1).flux_reg->CrseInit(flux, dir, 0, 0, 1, -1.0);
+            }
+            if (level > 0) {
+                Real mult = 1.0/ncycle;
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    if (d != dir) mult /= crse_ratio[d];
+                }
+                flux_reg->FineAdd(flux, dir, 0, 0, 1, mult);
+            }
+        }
+
+        return dt;
+    }
+
+    virtual void post_timestep (int /*iteration*/) override
+    {
+        if (level < parent->finestLevel()) {
+            MultiFab corr(grids, dmap, 1, 0);
+            corr.setVal(0.0);
+            getLevel(level+1).flux_reg->Reflux(corr, 1.0, 0, 0, 1, geom);
+            max_mismatch = std::max(max_mismatch, corr.norm0());
+        }
+    }
+
+    virtual void post_regrid (int /*lbase*/, int /*new_finest*/) override {}
+    virtual void post_init (Real /*stop_time*/) override {}
+
+    virtual void initData () override { initPhi(get_new_data(0), level); }
+
+    virtual void init (AmrLevel& old) override
+    {
+        CostLevel* oldlev = (CostLevel*) &old;
+        Real dt_new    = parent->dtLevel(level);
+        Real cur_time  = oldlev->state[0].curTime();
+        Real prev_time = oldlev->state[0].prevTime();
+        setTimeLevel(cur_time, cur_time-prev_time, dt_new);
+        FillPatch(old, get_new_data(0), 0, cur_time, 0, 0, 1);
+    }
+
+    virtual void init () override
+    {
+        Real dt        = parent->dtLevel(level);
+        Real cur_time  = getLevel(level-1).state[0].curTime();
+        Real prev_time = getLevel(level-1).state[0].prevTime();
+        setTimeLevel(cur_time, (cur_time-prev_time)/parent->MaxRefRatio(level-1), dt);
+        FillCoarsePatch(get_new_data(0), 0, cur_time, 0, 0, 1);
+    }
+
+    // Refine the middle half of the domain
+    virtual void errorEst (TagBoxArray& tags, int /*clearval*/, int tagval, Real /*time*/,
+                           int /*n_error_buf*/, int /*ngrow*/) override
+    {
+        const Box& domain = geom.Domain();
+        const Box middle(domain.smallEnd() + domain.length()/4,
+                         domain.bigEnd()   - domain.length()/4);
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox() & middle;
+            if (bx.ok()) {
+                tags[mfi].setVal(static_cast<TagBox::TagType>(tagval), bx);
+            }
+        }
+    }
+
+    // Whether phi is what the steps of this level made of the initial data
+    bool check () const { return checkPhi(get_new_data(0), level, parent->levelSteps(level)); }
+
+    CostLevel& getLevel (int lev) { return *(CostLevel*) &parent->getLevel(lev); }
+
+private:
+    std::unique_ptr<FluxRegister> flux_reg;
+};
+
+class CostLevelBld
+    :
+    public LevelBld
+{
+    virtual void variableSetUp () override { CostLevel::variableSetUp(); }
+    virtual void variableCleanUp () override { CostLevel::variableCleanUp(); }
+    virtual AmrLevel* operator() () override { return new CostLevel; }
+    virtual AmrLevel* operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new CostLevel(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+CostLevelBld Cost_bld;
+
+}
+
+LevelBld*
+getLevelBld ()
+{
+    return &Cost_bld;
+}
+
+// Amr calls it before the levels are built; there is nothing to read.
+extern "C" void
+amrex_probinit (const int* /*init*/, const int* /*name*/, const int* /*namelen*/,
+                const amrex_real* /*problo*/, const amrex_real* /*probhi*/)
+{}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int nsteps = 8;
+        int check_int = 4;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("nsteps", nsteps);
+            pp.query("check_int", check_int);
+            pp.query("heavy", heavy);
+        }
+
+        amrex::Print() << "Single level AmrCore, remapped every " << check_int << " steps\n";
+        {
+            RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+            CostTest amr(rb, Vector<int>(AMREX_SPACEDIM, n_cell));
+            amr.InitFromScratch(0.0);
+            amr.StartCostMeasurement(0);
+
+            int nremap = 0;
+            for (int step = 1; step <= nsteps; ++step) {
+                ParallelDescriptor::Barrier();
+                Real t0 = amrex::second();
+                amr.advance();
+                ParallelDescriptor::Barrier();
+                amrex::Print() << "  step " << step << ": " << amrex::second() - t0 << " s\n";
+                if (step % check_int == 0) {
+                    if (amr.LoadBalanceMeasuredCost(0, step)) ++nremap;
+                }
+            }
+
+            if (!amr.check(nsteps)) amrex::Abort("The data are not preserved by the remapping");
+            if (ParallelDescriptor::NProcs() > 1 && nremap == 0) {
+                amrex::Abort("The imbalanced level is not remapped");
+            }
+            amrex::Print() << "  " << nremap << " remapping(s), the data are preserved\n";
+        }
+
+        amrex::Print() << "Amr, remapped every amr.loadbalance_measured_int steps\n";
+        {
+            Amr amr;
+            amr.init(0.0, 1.e10);
+            if (amr.finestLevel() == 0) {
+                amrex::Abort("This test needs amr.max_level > 0");
+            }
+
+            // amr.regrid_int keeps the grids, so a changed DistributionMapping
+            // is a remap by the measured cost.
+            const int nlevels = amr.finestLevel() + 1;
+            Vector<int> nremap(nlevels, 0);
+            for (int step = 1; step <= nsteps; ++step) {
+                Vector<DistributionMapping> dm;
+                for (int lev = 0; lev < nlevels; ++lev) {
+                    dm.push_back(amr.DistributionMap(lev));
+                }
+                ParallelDescriptor::Barrier();
+                Real t0 = amrex::second();
+                amr.coarseTimeStep(1.e10);
+                ParallelDescriptor::Barrier();
+                amrex::Print() << "  step " << step << ": " << amrex::second() - t0 << " s\n";
+                if (amr.finestLevel()+1 != nlevels) {
+                    amrex::Abort("The levels have changed; set amr.regrid_int larger than nsteps");
+                }
+                for (int lev = 0; lev < nlevels; ++lev) {
+                    if (amr.DistributionMap(lev) != dm[lev]) ++nremap[lev];
+                }
+            }
+
+            bool ok = true;
+            for (int lev = 0; lev < nlevels; ++lev) {
+                const bool preserved = ((CostLevel&) amr.getLevel(lev)).check();
+                amrex::Print() << "  level " << lev << ": " << nremap[lev] << " remapping(s), "
+                               << (preserved ? "the data are preserved\n" : "the data are NOT preserved\n");
+                ok = ok && preserved;
+            }
+            amrex::Print() << "  largest flux register mismatch: " << max_mismatch << "\n";
+
+            if (!ok) amrex::Abort("The data are not preserved by the remapping");
+            if (max_mismatch != 0.0) {
+                amrex::Abort("A level was remapped after the coarser level filled its FluxRegister");
+            }
+            if (ParallelDescriptor::NProcs() > 1 && nremap[nlevels-1] == 0) {
+                amrex::Abort("The imbalanced fine level is not remapped");
+            }
+        }
+    }
+    amrex::Finalize();
+}
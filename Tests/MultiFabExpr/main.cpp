@@ -0,0 +1,459 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiFabExpr.H>
+#include <AMReX_ParallelReduce.H>
+
+#include <functional>
+#include <random>
+#include <string>
+
+using namespace amrex;
+
+namespace {
+
+const int nvecs = 8;
+
+void fillRandom (MultiFab& mf, int seed, Real lo = -1.0, Real hi = 1.0)
+{
+    std::mt19937 gen(seed*ParallelDescriptor::NProcs()+ParallelDescriptor::MyProc()+1);
+    std::uniform_real_distribution<Real> dist(lo, hi);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        FArrayBox& fab = mf[mfi];
+        Real* p = fab.dataPtr();
+        for (long i = 0, N = fab.box().numPts()*fab.nComp(); i < N; ++i) {
+            p[i] = dist(gen);
+        }
+    }
+}
+
+void fillRandom (Vector<MultiFab>& v)
+{
+    for (int m = 0; m < static_cast<int>(v.size()); ++m) {
+        fillRandom(v[m], m);
+    }
+}
+
+// The reductions and dot products are summed in a different order
+bool agree (Real a, Real b)
+{
+    return std::abs(a-b) <= 1.e-10*std::max(std::abs(a),std::abs(b));
+}
+
+//
+// Run the separate and the fused versions of an update nrep times on
+// copies of the same vectors, print the time and the bandwidth, i.e.,
+// the number of vectors read or written times their size over the time,
+// and check that they give the same vectors, ghost cells included, and
+// reductions.
+//
+bool compare (const std::string& name, int nbytes_vecs, int nrep,
+              const Vector<MultiFab>& v0,
+              const std::function<void(Vector<MultiFab>&,Vector<Real>&)>& separate,
+              const std::function<void(Vector<MultiFab>&,Vector<Real>&)>& fused)
+{
+    const BoxArray& ba = v0[0].boxArray();
+    const DistributionMapping& dm = v0[0].DistributionMap();
+    const int ncomp = v0[0].nComp();
+    const int ngrow = v0[0].nGrow();
+
+    Vector<MultiFab> vs(nvecs), vf(nvecs);
+    for (int m = 0; m < nvecs; ++m) {
+        vs[m].define(ba, dm, ncomp, ngrow);
+        vf[m].define(ba, dm, ncomp, ngrow);
+    }
+    Vector<Real> rs, rf;
+
+    Vector<Real> t(2);
+    for (int which = 0; which < 2; ++which) {
+        Vector<MultiFab>& v = (which == 0) ? vs : vf;
+        Vector<Real>& r = (which == 0) ? rs : rf;
+        t[which] = 0.0;
+        for (int rep = 0; rep < nrep; ++rep) {
+            for (int m = 0; m < nvecs; ++m) {
+                MultiFab::Copy(v[m], v0[m], 0, 0, ncomp, ngrow);
+            }
+            r.clear();
+            ParallelDescriptor::Barrier();
+            Real t0 = amrex::second();
+            if (which == 0) {
+                separate(v, r);
+            } else {
+                fused(v, r);
+            }
+            t[which] += amrex::second() - t0;
+        }
+        t[which] /= nrep;
+    }
+    ParallelDescriptor::ReduceRealMax(t.dataPtr(), 2);
+
+    bool ok = rs.size() == rf.size();
+    for (int m = 0; ok && m < static_cast<int>(rs.size()); ++m) {
+        ok = agree(rs[m], rf[m]);
+    }
+    for (int m = 0; m < nvecs; ++m) {
+        MultiFab::Subtract(vf[m], vs[m], 0, 0, ncomp, ngrow);
+        for (int n = 0; n < ncomp; ++n) {
+            if (vf[m].norm0(n, ngrow) > 1.e-14) ok = false;
+        }
+    }
+
+    const Real gbytes = Real(nbytes_vecs)*ba.numPts()*ncomp*sizeof(Real)/1.e9;
+    amrex::Print() << "  " << name << std::string(std::max(1,28-int(name.size())), ' ')
+                   << "separate " << t[0] << " (" << gbytes/t[0] << " GB/s)"
+                   << "  fused " << t[1] << " (" << gbytes/t[1] << " GB/s)"
+                   << "  speedup " << t[0]/t[1] << (ok ? "" : "  MISMATCH") << "\n";
+    return ok;
+}
+
+
+//
+// MultiDot of the Gram matrix of ndot vectors, with and without a
+// weight, and of a pair on another BoxArray, against Dot, then
+// DeferredAllReduce of sums and maxima.  Prints the time of the Gram
+// matrix with MultiDot and with a Dot per pair.
+//
+bool testMultiDot (const BoxArray& ba, const DistributionMapping& dm, int n_cell,
+                   int max_grid_size, int ncomp, int ndot, int nrep)
+{
+    bool ok = true;
+
+    // A second layout to check that pairs on different BoxArrays work
+    BoxArray ba2(Box(IntVect(0), IntVect(n_cell/2-1)));
+    ba2.maxSize(max_grid_size/2);
+    DistributionMapping dm2(ba2);
+
+    Vector<MultiFab> v(ndot);
+    for (int m = 0; m < ndot; ++m) {
+        v[m].define(ba, dm, ncomp, 1);
+        fillRandom(v[m], m, -1.0, 1.0);
+    }
+    MultiFab w(ba, dm, 1, 1);
+    fillRandom(w, ndot, 0.0, 1.0);
+    MultiFab u(ba2, dm2, ncomp, 1);
+    fillRandom(u, ndot+1, -1.0, 1.0);
+
+    // All the inner products of the vectors, as in a Gram matrix
+    Vector<const MultiFab*> x, y;
+    for (int j = 0; j < ndot; ++j) {
+        for (int i = 0; i < ndot; ++i) {
+            x.push_back(&v[i]);
+            y.push_back(&v[j]);
+        }
+    }
+    // The weight has the layout of v
+    const Vector<const MultiFab*> xw = x, yw = y;
+    x.push_back(&u);
+    y.push_back(&u);
+    const int npairs = x.size();
+
+    for (int nghost = 0; nghost <= 1; ++nghost) {
+        Vector<Real> r(npairs), rw(npairs);
+        MultiFab::MultiDot(x, 0, y, 0, ncomp, nghost, r.data());
+        MultiFab::MultiDot(xw, 0, yw, 0, ncomp, nghost, rw.data(), false, &w);
+        for (int m = 0; m+1 < npairs; ++m) {
+            ok = agree(r[m], MultiFab::Dot(*x[m], 0, *y[m], 0, ncomp, nghost)) && ok;
+            MultiFab tmp(ba, dm, ncomp, nghost);
+            MultiFab::Copy(tmp, *x[m], 0, 0, ncomp, nghost);
+            for (int n = 0; n < ncomp; ++n) {
+                MultiFab::Multiply(tmp, w, 0, n, 1, nghost);
+            }
+            ok = agree(rw[m], MultiFab::Dot(tmp, 0, *y[m], 0, ncomp, nghost)) && ok;
+        }
+        ok = agree(r[npairs-1], MultiFab::Dot(u, 0, u, 0, ncomp, nghost)) && ok;
+
+        // The weighted pairs as the GPU path does them, one ReduceSum
+        // of x, y and w per pair, and MultiDot outside the launch region
+        Vector<Real> rh(npairs-1);
+        {
+            Gpu::LaunchSafeGuard lsg(false);
+            MultiFab::MultiDot(xw, 0, yw, 0, ncomp, nghost, rh.data(), false, &w);
+        }
+        for (int m = 0; m+1 < npairs; ++m) {
+            Real s = amrex::ReduceSum(*xw[m], *yw[m], w, nghost,
+            [=] AMREX_GPU_HOST_DEVICE (Box const& bx, FArrayBox const& xfab,
+                                       FArrayBox const& yfab, FArrayBox const& wfab) -> Real
+            {
+                auto const xa = xfab.const_array();
+                auto const ya = yfab.const_array();
+                auto const wa = wfab.const_array();
+                const auto lo = amrex::lbound(bx);
+                const auto hi = amrex::ubound(bx);
+                Real r = 0.0;
+                for             (int n = 0; n < ncomp; ++n) {
+                    for         (int k = lo.z; k <= hi.z; ++k) {
+                        for     (int j = lo.y; j <= hi.y; ++j) {
+                            for (int i = lo.x; i <= hi.x; ++i) {
+                                r += wa(i,j,k)*xa(i,j,k,n)*ya(i,j,k,n);
+                            }
+                        }
+                    }
+                }
+                return r;
+            });
+            ParallelDescriptor::ReduceRealSum(s);
+            ok = agree(rw[m], s) && ok;
+            ok = agree(rw[m], rh[m]) && ok;
+        }
+    }
+
+    // A batch with sums and maxima, only sums and only maxima
+    const int me = ParallelDescriptor::MyProc();
+    const int nprocs = ParallelDescriptor::NProcs();
+    DeferredAllReduce reduce(ParallelContext::CommunicatorSub());
+    for (int which = 0; which < 3; ++which) {
+        Real s[3] = { 1.0, Real(me), -Real(me) };
+        Real mx[2] = { Real(me), -Real(me) };
+        if (which != 2) reduce.addSum(s, 3);
+        if (which != 1) reduce.addMax(mx, 2);
+        reduce.start();
+        reduce.wait();
+        if (which != 2) {
+            ok = ok && s[0] == nprocs && s[1] == nprocs*(nprocs-1)/2 && s[2] == -s[1];
+        }
+        if (which != 1) {
+            ok = ok && mx[0] == nprocs-1 && mx[1] == 0.0;
+        }
+    }
+
+    // A batch long enough for MPI to reduce it in segments
+    {
+        const int nsum = 200000, nmax = 1000;
+        Vector<Real> s(nsum), mx(nmax);
+        for (int i = 0; i < nsum; ++i) s[i] = Real(i%7 + me);
+        for (int i = 0; i < nmax; ++i) mx[i] = Real((i+me)%nprocs);
+        reduce.addSum(s.data(), nsum);
+        reduce.addMax(mx.data(), nmax);
+        reduce.reduce();
+        for (int i = 0; i < nsum; ++i) {
+            ok = ok && s[i] == Real(nprocs*(i%7) + nprocs*(nprocs-1)/2);
+        }
+        for (int i = 0; i < nmax; ++i) {
+            ok = ok && mx[i] == Real(nprocs-1);
+        }
+    }
+
+    // The Gram matrix with a Dot per pair and with MultiDot
+    Vector<Real> t(2, 0.0);
+    Vector<Real> r(npairs-1);
+    for (int rep = 0; rep < nrep; ++rep) {
+        ParallelDescriptor::Barrier();
+        Real t0 = amrex::second();
+        for (int m = 0; m < npairs-1; ++m) {
+            r[m] = MultiFab::Dot(*xw[m], 0, *yw[m], 0, ncomp, 0);
+        }
+        Real t1 = amrex::second();
+        MultiFab::MultiDot(xw, 0, yw, 0, ncomp, 0, r.data());
+        Real t2 = amrex::second();
+        t[0] += t1-t0;
+        t[1] += t2-t1;
+    }
+    ParallelDescriptor::ReduceRealMax(t.dataPtr(), 2);
+    amrex::Print() << "  " << npairs-1 << " dot products of " << ba.numPts() << " cells:"
+                   << "  Dot " << t[0]/nrep << "  MultiDot " << t[1]/nrep
+                   << "  speedup " << t[0]/t[1] << "\n";
+
+    amrex::Print() << "  MultiDot and DeferredAllReduce" << (ok ? " agree\n" : " MISMATCH\n");
+    return ok;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 128;
+        int max_grid_size = 64;
+        int ncomp = 1;
+        int nrep = 20;
+        int ndot = 4;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ncomp", ncomp);
+            pp.query("nrep", nrep);
+            pp.query("ndot", ndot);
+        }
+
+        BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+        Vector<MultiFab> v0(nvecs);
+        for (auto& mf : v0) mf.define(ba, dm, ncomp, 0);
+        fillRandom(v0);
+
+        const Real a = 0.7, b = -1.3;
+
+        amrex::Print() << "Updates of " << ba.numPts() << " cells, " << ncomp << " component(s)\n";
+        bool ok = true;
+
+        // x = a*y + b*z
+        ok = compare("lincomb", 3, nrep, v0,
+            [=] (Vector<MultiFab>& v, Vector<Real>&) {
+                MultiFab::LinComb(v[0], a, v[1], 0, b, v[2], 0, 0, ncomp, 0);
+            },
+            [=] (Vector<MultiFab>& v, Vector<Real>&) {
+                using namespace MFExpr;
+                eval(ncomp, 0, assign(v[0], a*ref(v[1]) + b*ref(v[2])));
+            }) && ok;
+
+        // x = x + a*p; r = r - a*q; |r|_inf; r.r
+        ok = compare("cg update", 6, nrep, v0,
+            [=] (Vector<MultiFab>& v, Vector<Real>& r) {
+                MultiFab::Saxpy(v[0],  a, v[1], 0, 0, ncomp, 0);
+                MultiFab::Saxpy(v[2], -a, v[3], 0, 0, ncomp, 0);
+                Real rnorm = 0.0;
+                for (int n = 0; n < ncomp; ++n) rnorm = std::max(rnorm, v[2].norm0(n));
+                r.push_back(rnorm);
+                r.push_back(MultiFab::Dot(v[2], 0, v[2], 0, ncomp, 0));
+            },
+            [=] (Vector<MultiFab>& v, Vector<Real>& r) {
+                using namespace MFExpr;
+                Real rnorm, rho;
+                eval(ncomp, 0,
+                     assign(v[0], ref(v[0]) + a*ref(v[1])),
+                     assign(v[2], ref(v[2]) - a*ref(v[3])),
+                     norminf(ref(v[2]), rnorm),
+                     dot(ref(v[2]), ref(v[2]), rho));
+                r.push_back(rnorm);
+                r.push_back(rho);
+            }) && ok;
+
+        // p = r + b*(p - a*v); ph = p
+        ok = compare("bicgstab p update", 5, nrep, v0,
+            [=] (Vector<MultiFab>& v, Vector<Real>&) {
+                MultiFab::LinComb(v[0], 1.0, v[0], 0, -a, v[1], 0, 0, ncomp, 0);
+                MultiFab::LinComb(v[0], 1.0, v[2], 0,  b, v[0], 0, 0, ncomp, 0);
+                MultiFab::Copy(v[3], v[0], 0, 0, ncomp, 0);
+            },
+            [=] (Vector<MultiFab>& v, Vector<Real>&) {
+                using namespace MFExpr;
+                eval(ncomp, 0,
+                     assign(v[0], ref(v[2]) + b*(ref(v[0]) - a*ref(v[1]))),
+                     assign(v[3], ref(v[0])));
+            }) && ok;
+
+        // x = x + a*sh; r = s - a*t; |r|_inf; rh.r
+        ok = compare("bicgstab x,r update", 7, nrep, v0,
+            [=] (Vector<MultiFab>& v, Vector<Real>& r) {
+                MultiFab::Saxpy(v[0], a, v[1], 0, 0, ncomp, 0);
+                MultiFab::LinComb(v[2], 1.0, v[3], 0, -a, v[4], 0, 0, ncomp, 0);
+                Real rnorm = 0.0;
+                for (int n = 0; n < ncomp; ++n) rnorm = std::max(rnorm, v[2].norm0(n));
+                r.push_back(rnorm);
+                r.push_back(MultiFab::Dot(v[5], 0, v[2], 0, ncomp, 0));
+            },
+            [=] (Vector<MultiFab>& v, Vector<Real>& r) {
+                using namespace MFExpr;
+                Real rnorm, rho;
+                eval(ncomp, 0,
+                     assign(v[0], ref(v[0]) + a*ref(v[1])),
+                     assign(v[2], ref(v[3]) - a*ref(v[4])),
+                     norminf(ref(v[2]), rnorm),
+                     dot(ref(v[5]), ref(v[2]), rho));
+                r.push_back(rnorm);
+                r.push_back(rho);
+            }) && ok;
+
+        // all the norms of one vector
+        ok = compare("norms", 1, nrep, v0,
+            [=] (Vector<MultiFab>& v, Vector<Real>& r) {
+                r.push_back(v[0].norm0(0));
+                r.push_back(v[0].norm1(0));
+                r.push_back(v[0].norm2(0));
+                r.push_back(v[0].sum(0));
+            },
+            [=] (Vector<MultiFab>& v, Vector<Real>& r) {
+                using namespace MFExpr;
+                Real n0, n1, n2, s;
+                eval(1, 0, norminf(ref(v[0]), n0), norm1(ref(v[0]), n1),
+                     norm2(ref(v[0]), n2), sum(ref(v[0]), s));
+                r.push_back(n0);
+                r.push_back(n1);
+                r.push_back(n2);
+                r.push_back(s);
+            }) && ok;
+
+        // dmask.x, dmask.y: sums weighted with a 0/1 mask
+        MultiFab dmask(ba, dm, 1, 0);
+        MultiFab wtmp(ba, dm, ncomp, 0);
+        for (MFIter mfi(dmask); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            auto const m = dmask.array(mfi);
+            auto const r = v0[nvecs-1].const_array(mfi);
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        m(i,j,k) = (r(i,j,k) > 0.0) ? 1.0 : 0.0;
+                    }
+                }
+            }
+        }
+        ok = compare("masked dot", 3, nrep, v0,
+            [&] (Vector<MultiFab>& v, Vector<Real>& r) {
+                MultiFab::Copy(wtmp, v[0], 0, 0, ncomp, 0);
+                for (int n = 0; n < ncomp; ++n) {
+                    MultiFab::Multiply(wtmp, dmask, 0, n, 1, 0);
+                }
+                r.push_back(MultiFab::Dot(wtmp, 0, v[1], 0, ncomp, 0));
+                r.push_back(MultiFab::Dot(wtmp, 0, ncomp, 0));
+            },
+            [&] (Vector<MultiFab>& v, Vector<Real>& r) {
+                using namespace MFExpr;
+                Real xy, xx;
+                eval(ncomp, 0,
+                     dot(weight(&dmask)*ref(v[0]), ref(v[1]), xy),
+                     sum(weight(&dmask)*ref(v[0])*ref(v[0]), xx));
+                r.push_back(xy);
+                r.push_back(xx);
+            }) && ok;
+
+        // The assignments on the ghost cells too, the reductions on the
+        // valid cells only
+        const int nghost = 2;
+        Vector<MultiFab> v0g(nvecs);
+        for (auto& mf : v0g) mf.define(ba, dm, ncomp, nghost);
+        fillRandom(v0g);
+
+        // x = x + a*p; r = r - a*q; |r|_inf; r.r; with ghost cells
+        ok = compare("cg update, ghost cells", 6, nrep, v0g,
+            [=] (Vector<MultiFab>& v, Vector<Real>& r) {
+                MultiFab::Saxpy(v[0],  a, v[1], 0, 0, ncomp, nghost);
+                MultiFab::Saxpy(v[2], -a, v[3], 0, 0, ncomp, nghost);
+                Real rnorm = 0.0;
+                for (int n = 0; n < ncomp; ++n) rnorm = std::max(rnorm, v[2].norm0(n));
+                r.push_back(rnorm);
+                r.push_back(MultiFab::Dot(v[2], 0, v[2], 0, ncomp, 0));
+            },
+            [=] (Vector<MultiFab>& v, Vector<Real>& r) {
+                using namespace MFExpr;
+                Real rnorm, rho;
+                eval(ncomp, nghost,
+                     assign(v[0], ref(v[0]) + a*ref(v[1])),
+                     assign(v[2], ref(v[2]) - a*ref(v[3])),
+                     norminf(ref(v[2]), rnorm),
+                     dot(ref(v[2]), ref(v[2]), rho));
+                r.push_back(rnorm);
+                r.push_back(rho);
+            }) && ok;
+
+        // x = a*y + b*z; with ghost cells and without reductions
+        ok = compare("lincomb, ghost cells", 3, nrep, v0g,
+            [=] (Vector<MultiFab>& v, Vector<Real>&) {
+                MultiFab::LinComb(v[0], a, v[1], 0, b, v[2], 0, 0, ncomp, nghost);
+            },
+            [=] (Vector<MultiFab>& v, Vector<Real>&) {
+                using namespace MFExpr;
+                eval(ncomp, nghost, assign(v[0], a*ref(v[1]) + b*ref(v[2])));
+            }) && ok;
+
+        ok = testMultiDot(ba, dm, n_cell, max_grid_size, ncomp, ndot, nrep) && ok;
+
+        if (!ok) amrex::Abort("MFExpr or MultiDot does not agree with the MultiFab functions");
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,123 @@
+#include <cmath>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_FabArrayUtility.H>
+
+using namespace amrex;
+
+namespace {
+
+// A 7-point Laplacian in an MFIter loop with tiling
+Real stencil (MultiFab& lap, const MultiFab& phi, int nrep)
+{
+    Real t0 = amrex::second();
+    for (int rep = 0; rep < nrep; ++rep) {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(lap,true); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.tilebox();
+            auto const l = lap.array(mfi);
+            auto const p = phi.array(mfi);
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        l(i,j,k) = AMREX_D_TERM(p(i-1,j,k) + p(i+1,j,k),
+                                               + p(i,j-1,k) + p(i,j+1,k),
+                                               + p(i,j,k-1) + p(i,j,k+1))
+                            - (2*AMREX_SPACEDIM)*p(i,j,k);
+                    }
+                }
+            }
+        }
+    }
+    Real t = (amrex::second() - t0)/nrep;
+    ParallelDescriptor::ReduceRealMax(t);
+    return t;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 128;
+        int max_grid_size = 64;
+        int nrep = 10;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nrep", nrep);
+        }
+
+        BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        const bool first_touch = FabArrayBase::FirstTouch;
+        bool ok = true;
+
+        // The first touch writes the initial value of the allocation
+        if (first_touch) {
+            const bool init_snan  = FArrayBox::set_init_snan(false);
+            const bool do_initval = FArrayBox::set_do_initval(true);
+            const Real initval    = FArrayBox::set_initval(3.0);
+            {
+                MultiFab init(ba, dm, 1, 1);
+                ok = init.min(0,1) == 3.0 && init.max(0,1) == 3.0;
+            }
+            FArrayBox::set_init_snan(true);
+            {
+                MultiFab init(ba, dm, 1, 1);
+                long npts = 0, nnan = 0;
+                for (MFIter mfi(init); mfi.isValid(); ++mfi) {
+                    const Box& bx = mfi.fabbox();
+                    npts += bx.numPts();
+                    const auto a = init.array(mfi);
+                    const auto lo = amrex::lbound(bx);
+                    const auto hi = amrex::ubound(bx);
+                    for         (int k = lo.z; k <= hi.z; ++k) {
+                        for     (int j = lo.y; j <= hi.y; ++j) {
+                            for (int i = lo.x; i <= hi.x; ++i) {
+                                if (std::isnan(a(i,j,k))) ++nnan;
+                            }
+                        }
+                    }
+                }
+                ok = ok && nnan == npts;
+            }
+            FArrayBox::set_init_snan(init_snan);
+            FArrayBox::set_do_initval(do_initval);
+            FArrayBox::set_initval(initval);
+        }
+
+        // Written by the master thread, or first touched by the MFIter threads
+        for (int touch = 0; touch < 1+first_touch; ++touch)
+        {
+            FabArrayBase::FirstTouch = touch;
+            MultiFab phi(ba, dm, 1, 1);
+            MultiFab lap(ba, dm, 1, 0);
+            for (MFIter mfi(phi); mfi.isValid(); ++mfi) {
+                phi[mfi].setVal(1.0);
+                lap[mfi].setVal(0.0);
+            }
+            FabArrayBase::FirstTouch = first_touch;
+
+            const std::string name = touch ? "first touched phi" : "master thread phi";
+            PrintNumaPlacement(phi, name);
+            const Real t = stencil(lap, phi, nrep);
+            amrex::Print() << "  " << name << ": stencil " << t << " s\n";
+            ok = ok && lap.norm0() == 0.0;
+        }
+
+        if (!ok) amrex::Abort("First touch changes the data");
+        amrex::Print() << "  first touch keeps the data\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,260 @@
+#include <iostream>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_BoxIterator.H>
+#include "AMReX_Particles.H"
+#include <AMReX_ParticleMesh.H>
+
+using namespace amrex;
+
+struct TestParams {
+  int nx;
+  int ny;
+  int nz;
+  int max_grid_size;
+  int nppc;
+  int nsteps;
+  bool verbose;
+};
+
+typedef ParticleContainer<1, 0, 1, 1> MyParticleContainer;
+
+//
+// Cloud-in-cell deposition of the particle mass.  Returns the wall time
+// of the fastest of nsteps depositions.
+//
+Real deposit (MyParticleContainer& pc, MultiFab& rho, int nsteps)
+{
+  const auto plo = pc.Geom(0).ProbLoArray();
+  const auto dxi = pc.Geom(0).InvCellSizeArray();
+
+  Real tmin = std::numeric_limits<Real>::max();
+  for (int step = 0; step < nsteps; ++step) {
+    ParallelDescriptor::Barrier();
+    const Real t0 = amrex::second();
+
+    amrex::ParticleToMesh(pc, rho, 0,
+        [=] AMREX_GPU_DEVICE (const MyParticleContainer::ParticleType& p,
+                              amrex::Array4<amrex::Real> const& a)
+        {
+            amrex::Real lx = (p.pos(0) - plo[0]) * dxi[0] + 0.5;
+            amrex::Real ly = (p.pos(1) - plo[1]) * dxi[1] + 0.5;
+            amrex::Real lz = (p.pos(2) - plo[2]) * dxi[2] + 0.5;
+
+            int i = std::floor(lx);
+            int j = std::floor(ly);
+            int k = std::floor(lz);
+
+            amrex::Real xint = lx - i;
+            amrex::Real yint = ly - j;
+            amrex::Real zint = lz - k;
+
+            amrex::Real sx[] = {1.-xint, xint};
+            amrex::Real sy[] = {1.-yint, yint};
+            amrex::Real sz[] = {1.-zint, zint};
+
+            for (int kk = 0; kk <= 1; ++kk) {
+                for (int jj = 0; jj <= 1; ++jj) {
+                    for (int ii = 0; ii <= 1; ++ii) {
+                        amrex::Gpu::Atomic::Add(&a(i+ii-1, j+jj-1, k+kk-1, 0),
+                                                sx[ii]*sy[jj]*sz[kk]*p.rdata(0));
+                    }
+                }
+            }
+        });
+
+    Real t = amrex::second() - t0;
+    ParallelDescriptor::ReduceRealMax(t);
+    tmin = std::min(tmin, t);
+  }
+  return tmin;
+}
+
+//
+// Check that the SoA data still belong to the particles they were
+// assigned to, that the particles of each tile are sorted by cell, and
+// that the per-cell index of each tile is consistent with the particles.
+//
+void check (MyParticleContainer& pc, bool morton)
+{
+  const auto plo = pc.Geom(0).ProbLoArray();
+  const auto dxi = pc.Geom(0).InvCellSizeArray();
+  const Box domain = pc.Geom(0).Domain();
+
+  long nbad = 0;
+  for (MyParticleContainer::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+    const auto& aos = pti.GetArrayOfStructs();
+    const auto& rdata = pti.GetStructOfArrays().GetRealData(0);
+    const auto& idata = pti.GetStructOfArrays().GetIntData(0);
+    const int np = pti.numParticles();
+    for (int i = 0; i < np; ++i) {
+      if (rdata[i] != static_cast<Real>(aos()[i].id()) || idata[i] != aos()[i].cpu()) ++nbad;
+      if (i > 0) {
+        IntVect a = getParticleCell(aos()[i-1], plo, dxi, domain);
+        IntVect b = getParticleCell(aos()[i  ], plo, dxi, domain);
+        bool ordered = morton ? (mortonKey(a-domain.smallEnd()) <= mortonKey(b-domain.smallEnd()))
+                              : (domain.index(a) <= domain.index(b));
+        if (!ordered) ++nbad;
+      }
+    }
+
+    if (!pti.hasCellIndex()) {
+      ++nbad;
+      continue;
+    }
+    const auto start = pti.cellStart();
+    const auto count = pti.cellCount();
+    const Box& bx = pti.tilebox();
+    long ntot = 0;
+    for (BoxIterator bi(bx); bi.ok(); ++bi) {
+      const IntVect& iv = bi();
+      for (int n = start(iv); n < start(iv)+count(iv); ++n) {
+        if (getParticleCell(aos()[n], plo, dxi, domain) != iv) ++nbad;
+      }
+      ntot += count(iv);
+    }
+    if (ntot != np) ++nbad;
+  }
+  ParallelDescriptor::ReduceLongSum(nbad);
+  if (nbad != 0) {
+    amrex::Abort("SortParticlesByCell: particle data are not consistent");
+  }
+}
+
+void testSortParticles (TestParams& parms)
+{
+  RealBox real_box;
+  for (int n = 0; n < BL_SPACEDIM; n++) {
+    real_box.setLo(n, 0.0);
+    real_box.setHi(n, 1.0);
+  }
+
+  IntVect domain_lo(AMREX_D_DECL(0, 0, 0));
+  IntVect domain_hi(AMREX_D_DECL(parms.nx - 1, parms.ny - 1, parms.nz-1));
+  const Box domain(domain_lo, domain_hi);
+
+  int is_per[BL_SPACEDIM];
+  for (int i = 0; i < BL_SPACEDIM; i++)
+    is_per[i] = 1;
+  Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+  BoxArray ba(domain);
+  ba.maxSize(parms.max_grid_size);
+
+  DistributionMapping dmap(ba);
+
+  MultiFab rho(ba, dmap, 1, 1);
+  MultiFab rho0(ba, dmap, 1, 1);
+
+  MyParticleContainer myPC(geom, dmap, ba);
+  myPC.SetVerbose(false);
+
+  long num_particles = static_cast<long>(parms.nppc) * parms.nx * parms.ny * parms.nz;
+  amrex::Print() << "Total number of particles    : " << num_particles << "\n\n";
+
+  bool serialize = false;
+  int iseed = 451;
+  MyParticleContainer::ParticleInitData pdata = {{10.0}, {}, {0.0}, {0}};
+  myPC.InitRandom(num_particles, iseed, pdata, serialize);
+
+  // tag the SoA data with the identity of their particle
+  for (MyParticleContainer::ParIterType pti(myPC, 0); pti.isValid(); ++pti) {
+    auto& aos = pti.GetArrayOfStructs();
+    auto& rdata = pti.GetStructOfArrays().GetRealData(0);
+    auto& idata = pti.GetStructOfArrays().GetIntData(0);
+    for (int i = 0; i < pti.numParticles(); ++i) {
+      rdata[i] = aos()[i].id();
+      idata[i] = aos()[i].cpu();
+    }
+  }
+
+  const Real t_unsorted = deposit(myPC, rho0, parms.nsteps);
+
+  Real t_sort = amrex::second();
+  myPC.SortParticlesByCell();
+  t_sort = amrex::second() - t_sort;
+  ParallelDescriptor::ReduceRealMax(t_sort);
+  check(myPC, false);
+
+  const Real t_sorted = deposit(myPC, rho, parms.nsteps);
+  MultiFab::Subtract(rho, rho0, 0, 0, 1, 0);
+  const Real diff_sorted = rho.norm0() / rho0.norm0();
+
+  Real t_morton_sort = amrex::second();
+  myPC.SortParticlesByCell(true);
+  t_morton_sort = amrex::second() - t_morton_sort;
+  ParallelDescriptor::ReduceRealMax(t_morton_sort);
+  check(myPC, true);
+
+  const Real t_morton = deposit(myPC, rho, parms.nsteps);
+  MultiFab::Subtract(rho, rho0, 0, 0, 1, 0);
+  const Real diff_morton = rho.norm0() / rho0.norm0();
+
+  // move the particles by up to a cell and check that Redistribute keeps
+  // the cell index up to date
+  const Real dx = geom.CellSize(0);
+  for (MyParticleContainer::ParIterType pti(myPC, 0); pti.isValid(); ++pti) {
+    auto& aos = pti.GetArrayOfStructs();
+    for (int i = 0; i < pti.numParticles(); ++i) {
+      for (int idim = 0; idim < BL_SPACEDIM; ++idim) {
+        aos()[i].pos(idim) += dx * std::sin(1.3*i + idim);
+      }
+    }
+  }
+  Real t_redist = amrex::second();
+  myPC.Redistribute();
+  t_redist = amrex::second() - t_redist;
+  ParallelDescriptor::ReduceRealMax(t_redist);
+  check(myPC, true);
+
+  if (diff_sorted > 1.e-12 || diff_morton > 1.e-12) {
+    amrex::Abort("SortParticlesByCell: deposition changed after sorting");
+  }
+
+  amrex::Print() << "Deposition time (unsorted)   : " << t_unsorted
+                 << " (" << num_particles/t_unsorted << " particles/s)\n"
+                 << "Deposition time (cell order) : " << t_sorted
+                 << " (" << num_particles/t_sorted << " particles/s)"
+                 << ", sort time " << t_sort << "\n"
+                 << "Deposition time (Morton)     : " << t_morton
+                 << " (" << num_particles/t_morton << " particles/s)"
+                 << ", sort time " << t_morton_sort << "\n"
+                 << "Redistribute with cell index : " << t_redist << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+  amrex::Initialize(argc,argv);
+
+  ParmParse pp;
+
+  TestParams parms;
+
+  pp.get("nx", parms.nx);
+  pp.get("ny", parms.ny);
+  pp.get("nz", parms.nz);
+  pp.get("max_grid_size", parms.max_grid_size);
+  pp.get("nppc", parms.nppc);
+  if (parms.nppc < 1 && ParallelDescriptor::IOProcessor())
+    amrex::Abort("Must specify at least one particle per cell");
+
+  parms.nsteps = 10;
+  pp.query("nsteps", parms.nsteps);
+
+  parms.verbose = false;
+  pp.query("verbose", parms.verbose);
+
+  if (parms.verbose && ParallelDescriptor::IOProcessor()) {
+    std::cout << std::endl;
+    std::cout << "Number of particles per cell : ";
+    std::cout << parms.nppc  << std::endl;
+    std::cout << "Size of domain               : ";
+    std::cout << parms.nx << " " << parms.ny << " " << parms.nz << std::endl;
+  }
+
+  testSortParticles(parms);
+
+  amrex::Finalize();
+}
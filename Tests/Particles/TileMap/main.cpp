@@ -0,0 +1,227 @@
+#include <iostream>
+#include <map>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include "AMReX_Particles.H"
+
+using namespace amrex;
+
+struct TestParams {
+  int nx;
+  int ny;
+  int nz;
+  int max_grid_size;
+  int nppc;
+  int nsteps;
+};
+
+typedef ParticleContainer<1, 0, 1, 1> MyParticleContainer;
+
+//
+// Check that ParticleTileMap behaves like the std::map it replaces when
+// tiles are added, looked up and erased while iterating.
+//
+void testMapSemantics ()
+{
+  using Tile = MyParticleContainer::ParticleTileType;
+  std::map<std::pair<int,int>, int> ref;
+  ParticleTileMap<Tile> tm;
+
+  for (int n = 0; n < 1000; ++n) {
+    const std::pair<int,int> key((n*37)%50, (n*11)%23);
+    MyParticleContainer::ParticleType p;
+    p.id() = n;
+    tm[key].push_back(p);
+    ref[key] += 1;
+  }
+
+  // erase every other tile while iterating, then add some of them back
+  int i = 0;
+  for (auto it = tm.begin(); it != tm.end(); ++i) {
+    if (i % 2 == 0) {
+      ref.erase(it->first);
+      tm.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  for (int n = 0; n < 100; ++n) {
+    const std::pair<int,int> key(n%50, n%7);
+    MyParticleContainer::ParticleType p;
+    tm[key].push_back(p);
+    ref[key] += 1;
+  }
+
+  // add tiles while iterating; the new ones are visited later, as in std::map
+  int nvisit = 0;
+  for (auto it = tm.begin(); it != tm.end(); ++it, ++nvisit) {
+    if (it->first.first < 5) {
+      tm[std::make_pair(it->first.first+60, it->first.second)];
+      ref[std::make_pair(it->first.first+60, it->first.second)];
+    }
+  }
+
+  bool ok = tm.size() == ref.size() && nvisit == static_cast<int>(ref.size());
+  auto rit = ref.begin();
+  for (auto const& kv : tm) {
+    if (rit == ref.end() || kv.first != rit->first ||
+        kv.second.numParticles() != rit->second) ok = false;
+    if (tm.find(kv.first) == tm.end() || tm.count(kv.first) != 1) ok = false;
+    if (rit != ref.end()) ++rit;
+  }
+  if (tm.find(std::make_pair(1000,0)) != tm.end()) ok = false;
+
+  if (!ok) amrex::Abort("ParticleTileMap: not consistent with std::map");
+}
+
+//
+// Time looking up every tile of the level, as ParIter does, in the
+// container's ParticleTileMap and in a std::map holding the same tiles.
+//
+void timeLookup (MyParticleContainer& pc, int nsteps, Real& t_flat, Real& t_map)
+{
+  using Tile = MyParticleContainer::ParticleTileType;
+  const auto& plev = pc.GetParticles(0);
+  std::map<std::pair<int,int>, Tile> tree(plev.begin(), plev.end());
+
+  Vector<std::pair<int,int> > keys;
+  for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi) {
+    keys.push_back(std::make_pair(mfi.index(), mfi.LocalTileIndex()));
+  }
+
+  const int nrep = 100*nsteps;
+  long n_flat = 0, n_map = 0;
+
+  t_flat = amrex::second();
+  for (int rep = 0; rep < nrep; ++rep) {
+    for (auto const& key : keys) {
+      auto it = plev.find(key);
+      if (it != plev.end()) n_flat += it->second.numParticles();
+    }
+  }
+  t_flat = amrex::second() - t_flat;
+
+  t_map = amrex::second();
+  for (int rep = 0; rep < nrep; ++rep) {
+    for (auto const& key : keys) {
+      auto it = tree.find(key);
+      if (it != tree.end()) n_map += it->second.numParticles();
+    }
+  }
+  t_map = amrex::second() - t_map;
+
+  if (n_flat != n_map) amrex::Abort("ParticleTileMap: lookups do not agree with std::map");
+
+  ParallelDescriptor::ReduceRealMax(t_flat);
+  ParallelDescriptor::ReduceRealMax(t_map);
+}
+
+void testTileMap (TestParams& parms)
+{
+  RealBox real_box;
+  for (int n = 0; n < BL_SPACEDIM; n++) {
+    real_box.setLo(n, 0.0);
+    real_box.setHi(n, 1.0);
+  }
+
+  IntVect domain_lo(AMREX_D_DECL(0, 0, 0));
+  IntVect domain_hi(AMREX_D_DECL(parms.nx - 1, parms.ny - 1, parms.nz-1));
+  const Box domain(domain_lo, domain_hi);
+
+  int is_per[BL_SPACEDIM];
+  for (int i = 0; i < BL_SPACEDIM; i++)
+    is_per[i] = 1;
+  Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+  BoxArray ba(domain);
+  ba.maxSize(parms.max_grid_size);
+
+  DistributionMapping dmap(ba);
+
+  MyParticleContainer myPC(geom, dmap, ba);
+  myPC.SetVerbose(false);
+
+  long num_particles = static_cast<long>(parms.nppc) * parms.nx * parms.ny * parms.nz;
+  amrex::Print() << "Total number of particles    : " << num_particles << "\n";
+
+  bool serialize = false;
+  int iseed = 451;
+  MyParticleContainer::ParticleInitData pdata = {{10.0}, {}, {0.0}, {0}};
+  myPC.InitRandom(num_particles, iseed, pdata, serialize);
+
+  long ntiles = myPC.GetParticles(0).size();
+  ParallelDescriptor::ReduceLongSum(ntiles);
+  amrex::Print() << "Total number of tiles        : " << ntiles << "\n\n";
+
+  // iterate over the tiles, doing little work on each
+  Real t_iter = amrex::second();
+  Real msum = 0.0;
+  for (int step = 0; step < parms.nsteps; ++step) {
+    for (MyParticleContainer::ParIterType pti(myPC, 0); pti.isValid(); ++pti) {
+      const auto& aos = pti.GetArrayOfStructs();
+      if (pti.numParticles() > 0) msum += aos()[0].rdata(0);
+    }
+  }
+  t_iter = amrex::second() - t_iter;
+  ParallelDescriptor::ReduceRealMax(t_iter);
+  ParallelDescriptor::ReduceRealSum(msum);
+
+  // move the particles by up to half a cell and redistribute them
+  const Real dx = geom.CellSize(0);
+  Real t_redist = 0.0;
+  for (int step = 0; step < parms.nsteps; ++step) {
+    for (MyParticleContainer::ParIterType pti(myPC, 0); pti.isValid(); ++pti) {
+      auto& aos = pti.GetArrayOfStructs();
+      for (int i = 0; i < pti.numParticles(); ++i) {
+        for (int idim = 0; idim < BL_SPACEDIM; ++idim) {
+          aos()[i].pos(idim) += 0.5 * dx * std::sin(1.3*i + idim + step);
+        }
+      }
+    }
+    ParallelDescriptor::Barrier();
+    Real t0 = amrex::second();
+    myPC.Redistribute();
+    t_redist += amrex::second() - t0;
+  }
+  ParallelDescriptor::ReduceRealMax(t_redist);
+
+  if (myPC.TotalNumberOfParticles() != num_particles) {
+    amrex::Abort("ParticleTileMap: particles were lost in Redistribute");
+  }
+
+  Real t_flat, t_map;
+  timeLookup(myPC, parms.nsteps, t_flat, t_map);
+
+  amrex::Print() << "ParIter loop time            : " << t_iter/parms.nsteps
+                 << " (checksum " << msum << ")\n"
+                 << "Redistribute time            : " << t_redist/parms.nsteps << "\n"
+                 << "Tile lookups, ParticleTileMap: " << t_flat << "\n"
+                 << "Tile lookups, std::map       : " << t_map << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+  amrex::Initialize(argc,argv);
+
+  ParmParse pp;
+
+  TestParams parms;
+
+  pp.get("nx", parms.nx);
+  pp.get("ny", parms.ny);
+  pp.get("nz", parms.nz);
+  pp.get("max_grid_size", parms.max_grid_size);
+  pp.get("nppc", parms.nppc);
+  if (parms.nppc < 1 && ParallelDescriptor::IOProcessor())
+    amrex::Abort("Must specify at least one particle per cell");
+
+  parms.nsteps = 10;
+  pp.query("nsteps", parms.nsteps);
+
+  testMapSemantics();
+  testTileMap(parms);
+
+  amrex::Finalize();
+}
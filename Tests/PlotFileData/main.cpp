@@ -0,0 +1,204 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_PlotFileUtil.H>
+
+#include <random>
+
+using namespace amrex;
+
+namespace {
+
+Real value (int i, int j, int k, int n, int lev)
+{
+    return std::sin(0.1*i + 0.2*j + 0.3*k + n) + 10.*lev + 100.*n;
+}
+
+void writePlotfile (const std::string& name, int n_cell, int max_grid_size, int ncomp)
+{
+    const int nlevs = 2;
+    Vector<Geometry> geom(nlevs);
+    Vector<BoxArray> ba(nlevs);
+    Vector<DistributionMapping> dm(nlevs);
+    Vector<MultiFab> mf(nlevs);
+    Vector<IntVect> ref_ratio(nlevs-1, IntVect(2));
+
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    for (int lev = 0; lev < nlevs; ++lev) {
+        geom[lev].define(domain, &rb, CoordSys::cartesian, is_periodic.data());
+        domain.refine(2);
+    }
+
+    ba[0].define(geom[0].Domain());
+    ba[0].maxSize(max_grid_size);
+    ba[1].define(Box(IntVect(n_cell/2), IntVect(n_cell+n_cell/2-1)));
+    ba[1].maxSize(max_grid_size);
+
+    Vector<std::string> varnames;
+    for (int n = 0; n < ncomp; ++n) {
+        varnames.push_back("comp"+std::to_string(n));
+    }
+
+    for (int lev = 0; lev < nlevs; ++lev) {
+        dm[lev].define(ba[lev]);
+        mf[lev].define(ba[lev], dm[lev], ncomp, 0);
+        for (MFIter mfi(mf[lev]); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            const auto& a = mf[lev].array(mfi);
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            for (int n = 0; n < ncomp; ++n) {
+                for         (int k = lo.z; k <= hi.z; ++k) {
+                    for     (int j = lo.y; j <= hi.y; ++j) {
+                        for (int i = lo.x; i <= hi.x; ++i) {
+                            a(i,j,k,n) = value(i,j,k,n,lev);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    WriteMultiLevelPlotfile(name, nlevs, GetVecOfConstPtrs(mf), varnames,
+                            geom, 0.0, Vector<int>(nlevs,0), ref_ratio);
+}
+
+//
+// Compare get(level,icomp,region) with reading the whole level.
+//
+bool checkRegions (PlotFileData& pf, int nregions)
+{
+    std::mt19937 gen(42);
+    bool ok = true;
+    for (int lev = 0; lev <= pf.finestLevel(); ++lev) {
+        const MultiFab mf = pf.get(lev);
+        const Box& domain = pf.probDomain(lev);
+        std::uniform_int_distribution<int> corner(-8, domain.bigEnd(0)+8);
+        std::uniform_int_distribution<int> size(1, 40);
+        std::uniform_int_distribution<int> comp(0, pf.nComp()-1);
+        for (int r = 0; r < nregions; ++r) {
+            IntVect lo, hi;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                lo[idim] = corner(gen);
+                hi[idim] = lo[idim] + size(gen);
+            }
+            const Box region(lo,hi);
+            const int icomp = comp(gen);
+
+            const FArrayBox fab = pf.get(lev, icomp, region);
+            const Box bx = region & pf.boxArray(lev).minimalBox();
+            if (!bx.ok()) {
+                if (fab.box().ok()) ok = false;
+                continue;
+            }
+            if (fab.box() != bx) ok = false;
+
+            // every process has the whole region; check what this process owns
+            for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                const Box& b = mfi.validbox() & bx;
+                if (b.ok()) {
+                    for (BoxIterator bi(b); bi.ok(); ++bi) {
+                        if (fab(bi(),0) != mf[mfi](bi(),icomp)) ok = false;
+                    }
+                }
+            }
+            // cells not covered by any grid are zero
+            for (BoxIterator bi(bx); bi.ok(); ++bi) {
+                if (!pf.boxArray(lev).contains(bi()) && fab(bi(),0) != 0.0) ok = false;
+            }
+        }
+    }
+    ParallelDescriptor::ReduceBoolAnd(ok);
+    return ok;
+}
+
+//
+// Extract a line through the center of the domain in x, for every
+// component, as fextract does.
+//
+void timeLine (const std::string& name, int ncomp)
+{
+    Real t_full, t_region;
+    {
+        PlotFileData pf(name);
+        Box line = pf.probDomain(0);
+        const IntVect c = line.smallEnd() + line.length()/2;
+        for (int idim = 1; idim < AMREX_SPACEDIM; ++idim) {
+            line.setRange(idim, c[idim]);
+        }
+
+        ParallelDescriptor::Barrier();
+        t_full = amrex::second();
+        Real s = 0.0;
+        for (int n = 0; n < ncomp; ++n) {
+            const MultiFab mf = pf.get(0, pf.varNames()[n]);
+            for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                const Box& b = mfi.validbox() & line;
+                if (b.ok()) s += mf[mfi].sum(b, 0, 1);
+            }
+        }
+        ParallelDescriptor::ReduceRealSum(s);
+        t_full = amrex::second() - t_full;
+        ParallelDescriptor::ReduceRealMax(t_full);
+
+        ParallelDescriptor::Barrier();
+        t_region = amrex::second();
+        pf.setReadAhead(ncomp-1);
+        Real s2 = 0.0;
+        for (int n = 0; n < ncomp; ++n) {
+            const FArrayBox fab = pf.get(0, n, line);
+            s2 += fab.sum(0);
+        }
+        t_region = amrex::second() - t_region;
+        ParallelDescriptor::ReduceRealMax(t_region);
+
+        if (std::abs(s-s2) > 1.e-10*std::abs(s)) amrex::Abort("PlotFileData: line sums do not agree");
+    }
+
+    amrex::Print() << "Line through level 0, all components:\n"
+                   << "  whole level read   : " << t_full << "\n"
+                   << "  region read        : " << t_region << "\n";
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 128;
+        int max_grid_size = 32;
+        int ncomp = 8;
+        int nregions = 50;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ncomp", ncomp);
+            pp.query("nregions", nregions);
+        }
+
+        const std::string name = "plt_region";
+        writePlotfile(name, n_cell, max_grid_size, ncomp);
+
+        PlotFileData pf(name);
+        if (!checkRegions(pf, nregions)) {
+            amrex::Abort("PlotFileData::get(level,icomp,region) does not agree with get(level)");
+        }
+
+        // again with a cache too small to hold a grid
+        PlotFileData pf2(name);
+        pf2.setCacheSize(0);
+        pf2.setReadAhead(2);
+        if (!checkRegions(pf2, nregions)) {
+            amrex::Abort("PlotFileData::get(level,icomp,region) does not agree with get(level)");
+        }
+
+        amrex::Print() << "Regions read from plotfile agree\n";
+
+        timeLine(name, ncomp);
+    }
+    amrex::Finalize();
+}
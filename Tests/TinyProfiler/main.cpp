@@ -0,0 +1,344 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_BLProfiler.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace amrex;
+
+namespace {
+
+void spin (Real dt)
+{
+    const Real t0 = amrex::second();
+    while (amrex::second() - t0 < dt) {}
+}
+
+// A JSON value.  Those of objects and arrays are indices into the parser's pool.
+struct Json
+{
+    char type = 0;                  // '{', '[', '"' or '0'
+    std::string str;
+    double num = 0.0;
+    std::vector<std::string> keys;  // of an object
+    std::vector<int> vals;
+};
+
+class JsonParser
+{
+public:
+
+    explicit JsonParser (const std::string& text) : s(text) {}
+
+    // The index of the top-level value, or -1 if the text is not valid JSON.
+    // There are no true, false or null in what TinyProfiler writes.
+    int parse ()
+    {
+        const int v = value();
+        ws();
+        return (ok && pos == s.size()) ? v : -1;
+    }
+
+    const Json& operator[] (int i) const { return pool[i]; }
+
+    // The value of key in object i, or -1
+    int find (int i, const std::string& key) const
+    {
+        if (i < 0 || pool[i].type != '{') return -1;
+        for (int k = 0; k < static_cast<int>(pool[i].keys.size()); ++k) {
+            if (pool[i].keys[k] == key) return pool[i].vals[k];
+        }
+        return -1;
+    }
+
+private:
+
+    void ws () { while (pos < s.size() && std::isspace(s[pos])) ++pos; }
+
+    bool eat (char c)
+    {
+        ws();
+        if (pos < s.size() && s[pos] == c) { ++pos; return true; }
+        return false;
+    }
+
+    bool string (std::string& r)
+    {
+        ws();
+        if (pos >= s.size() || s[pos] != '"') return false;
+        for (++pos; pos < s.size() && s[pos] != '"'; ++pos) {
+            if (s[pos] == '\\') ++pos;
+            if (pos < s.size()) r += s[pos];
+        }
+        return pos++ < s.size();
+    }
+
+    int value ()
+    {
+        ws();
+        if (!ok || pos >= s.size()) { ok = false; return -1; }
+        Json j;
+        if (eat('{')) {
+            j.type = '{';
+            if (!eat('}')) {
+                do {
+                    std::string key;
+                    ok = ok && string(key) && eat(':');
+                    j.keys.push_back(key);
+                    j.vals.push_back(value());
+                } while (ok && eat(','));
+                ok = ok && eat('}');
+            }
+        } else if (eat('[')) {
+            j.type = '[';
+            if (!eat(']')) {
+                do {
+                    j.vals.push_back(value());
+                } while (ok && eat(','));
+                ok = ok && eat(']');
+            }
+        } else if (s[pos] == '"') {
+            j.type = '"';
+            ok = string(j.str);
+        } else if (s[pos] == '-' || std::isdigit(s[pos])) {
+            j.type = '0';
+            char* end;
+            j.num = std::strtod(s.c_str()+pos, &end);
+            pos = end - s.c_str();
+        } else {
+            ok = false;
+        }
+        if (!ok) return -1;
+        pool.push_back(j);
+        return pool.size()-1;
+    }
+
+    const std::string& s;
+    std::size_t pos = 0;
+    bool ok = true;
+    std::vector<Json> pool;
+};
+
+// Adds the ncalls of the node and its descendants to calls, by '/'-separated
+// path.  Whether each node has all the fields WriteCallTree writes.
+bool jsonCalls (const JsonParser& p, int node, const std::string& prefix,
+                std::map<std::string,double>& calls)
+{
+    const int name = p.find(node, "name");
+    const int ncalls = p.find(node, "ncalls");
+    const int children = p.find(node, "children");
+    if (name < 0 || p[name].type != '"' || ncalls < 0 || p[ncalls].type != '0' ||
+        children < 0 || p[children].type != '[') {
+        return false;
+    }
+    for (const char* stat : {"incl", "excl", "thread_incl"}) {
+        const int st = p.find(node, stat);
+        for (const char* m : {"min", "avg", "max"}) {
+            const int v = p.find(st, m);
+            if (v < 0 || p[v].type != '0') return false;
+        }
+    }
+    const std::string path = prefix.empty() ? p[name].str : prefix + "/" + p[name].str;
+    calls[path] = p[ncalls].num;
+    for (int c : p[children].vals) {
+        if (!jsonCalls(p, c, path, calls)) return false;
+    }
+    return true;
+}
+
+// The ncalls of each path in the CSV call tree, or false if it is malformed
+bool csvCalls (std::istream& is, std::map<std::string,double>& calls)
+{
+    std::string line;
+    std::getline(is, line);
+    if (line.compare(0, 12, "path,depth,n") != 0) return false;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] != '"') return false;
+        std::string path;
+        std::size_t pos = 1;
+        for (; pos < line.size(); ++pos) {
+            if (line[pos] == '"') {
+                if (pos+1 < line.size() && line[pos+1] == '"') {
+                    ++pos;
+                } else {
+                    break;
+                }
+            }
+            path += line[pos];
+        }
+        if (pos+1 >= line.size() || line[pos+1] != ',') return false;
+        std::istringstream fields(line.substr(pos+2));
+        std::vector<double> v;
+        std::string f;
+        while (std::getline(fields, f, ',')) {
+            char* end;
+            v.push_back(std::strtod(f.c_str(), &end));
+            if (f.empty() || *end != '\0') return false;
+        }
+        if (v.size() != 11) return false;
+        if (static_cast<int>(v[0]) != std::count(path.begin(), path.end(), '/')) return false;
+        calls[path] = v[1];
+    }
+    return true;
+}
+
+bool check (const std::string& name, bool ok)
+{
+    amrex::Print() << "  " << name << (ok ? ": ok\n" : ": FAILED\n");
+    return ok;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+#if !defined(AMREX_TINY_PROFILING) || !defined(_OPENMP)
+        amrex::Abort("This test needs TINY_PROFILE = TRUE and USE_OMP = TRUE");
+#else
+        if (omp_get_max_threads() < 2) {
+            amrex::Abort("This test needs OMP_NUM_THREADS > 1");
+        }
+
+        int nouter = 4;
+        int ninner = 3;
+        Real dt = 1.e-4;
+        std::string output_file;
+        {
+            ParmParse pp;
+            pp.query("nouter", nouter);
+            pp.query("ninner", ninner);
+            pp.query("dt", dt);
+            ParmParse pptp("tiny_profiler");
+            pptp.get("output_file", output_file);
+        }
+
+        // The master thread alone calls outer().  Every thread calls work() and
+        // inner(), the later threads for longer.  A region nested in the parallel
+        // one is timed when it is serialized, and not when it is active.
+        int nthreads = 0;
+        {
+            BL_PROFILE("outer()");
+            for (int active_levels : {1, 2}) {
+                omp_set_max_active_levels(active_levels);
+#pragma omp parallel
+                {
+#pragma omp single
+                    nthreads = omp_get_num_threads();
+                    for (int i = 0; i < nouter; ++i) {
+                        BL_PROFILE("work()");
+                        for (int j = 0; j < ninner; ++j) {
+                            BL_PROFILE("inner()");
+                            spin(dt*(1+omp_get_thread_num()));
+                        }
+#pragma omp parallel num_threads(2)
+                        {
+                            BL_PROFILE((active_levels == 1) ? "serialized()" : "nested()");
+                        }
+                    }
+                }
+            }
+            omp_set_max_active_levels(1);
+        }
+
+        // Flush, keeping what is printed
+        std::ostringstream os;
+        std::streambuf* coutbuf = std::cout.rdbuf(os.rdbuf());
+        TinyProfiler::Finalize(true);
+        std::cout.rdbuf(coutbuf);
+        amrex::Print() << os.str();
+
+        int ok = 1;
+        if (ParallelDescriptor::IOProcessor())
+        {
+            const std::string& out = os.str();
+            ok = check("timers properly nested",
+                       out.find("not properly nested") == std::string::npos) && ok;
+
+            // The functions that ran on more than one thread, and the spread of inner()
+            std::set<std::string> names;
+            Real inner_min = 0.0, inner_max = 0.0;
+            const auto start = out.find("Inclusive time across the threads of each process");
+            if (start != std::string::npos) {
+                std::istringstream is(out.substr(start));
+                std::string line;
+                int nhline = 0;
+                while (nhline < 3 && std::getline(is, line)) {
+                    if (line.compare(0, 4, "----") == 0) {
+                        ++nhline;
+                    } else if (nhline == 2) {
+                        std::istringstream row(line);
+                        std::string name;
+                        Real tmin, tavg, tmax;
+                        row >> name >> tmin >> tavg >> tmax;
+                        names.insert(name);
+                        if (name == "inner()") {
+                            inner_min = tmin;
+                            inner_max = tmax;
+                        }
+                    }
+                }
+            }
+            const std::set<std::string> threaded {"inner()", "serialized()", "work()"};
+            ok = check("thread stats of the threaded functions", names == threaded) && ok;
+            ok = check("thread spread of inner()", inner_max > inner_min) && ok;
+
+            // ncalls is per process: all threads, averaged over the processes
+            const double nwork = 2.0*nthreads*nouter;
+            const std::map<std::string,double> expected {
+                {"main", 1.0},
+                {"main/outer()", 1.0},
+                {"main/outer()/work()", nwork},
+                {"main/outer()/work()/inner()", nwork*ninner},
+                {"main/outer()/work()/serialized()", nwork/2}};
+
+            std::ifstream ifs(output_file);
+            std::map<std::string,double> calls;
+            bool parsed = false;
+            const bool csv = output_file.size() >= 4
+                && output_file.compare(output_file.size()-4, 4, ".csv") == 0;
+            if (!ifs.good()) {
+                amrex::Print() << "  cannot open " << output_file << "\n";
+            } else if (csv) {
+                parsed = csvCalls(ifs, calls);
+            } else {
+                std::stringstream ss;
+                ss << ifs.rdbuf();
+                const std::string text = ss.str();
+                JsonParser p(text);
+                const int top = p.parse();
+                const int nprocs = p.find(top, "nprocs");
+                const int nthr = p.find(top, "nthreads");
+                parsed = nprocs >= 0 && p[nprocs].num == ParallelDescriptor::NProcs()
+                    && nthr >= 0 && p[nthr].num == omp_get_max_threads()
+                    && jsonCalls(p, p.find(top, "calltree"), "", calls);
+            }
+            ok = check(output_file + " parses", parsed) && ok;
+            for (auto const& kv : calls) {
+                amrex::Print() << "    " << kv.first << ": " << kv.second << "\n";
+            }
+            ok = check(output_file + " call tree and counts", calls == expected) && ok;
+        }
+        ParallelDescriptor::Bcast(&ok, 1, ParallelDescriptor::IOProcessorNumber());
+        if (!ok) amrex::Abort("TinyProfiler thread stats or call tree are wrong");
+#endif
+    }
+    amrex::Finalize();
+}
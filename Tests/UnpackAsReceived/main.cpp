@@ -0,0 +1,256 @@
+#include <cmath>
+#include <functional>
+#include <string>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+
+using namespace amrex;
+
+namespace {
+
+// Values that depend on the global index and on shift only, of varying
+// magnitude so that a sum in a different order is not bitwise the same
+void fill (MultiFab& mf, int shift = 0)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.fabbox();
+        auto const a = mf.array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for (int n = 0; n < mf.nComp(); ++n) {
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        a(i,j,k,n) = std::sin(0.37*i + 1.1*j + 2.3*k + n + shift)
+                            * std::pow(10.0, (i+2*j+3*k+mfi.index())%9 - 4);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// The number of values, ghost cells included, that are not bitwise equal
+long ndiff (const MultiFab& a, const MultiFab& b)
+{
+    long n = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.fabbox();
+        auto const x = a.const_array(mfi);
+        auto const y = b.const_array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for (int m = 0; m < a.nComp(); ++m) {
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        if (x(i,j,k,m) != y(i,j,k,m)) ++n;
+                    }
+                }
+            }
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(n);
+    return n;
+}
+
+bool report (const std::string& name, long n)
+{
+    amrex::Print() << "  " << name << ": " << n << " values differ\n";
+    return n == 0;
+}
+
+// The number of exchanges done with persistent CommPlans so far
+struct PlanStats
+    : FabArrayBase
+{
+    static long nplanuse ()
+    {
+        long n = m_FBC_stats.nplanuse + m_CPC_stats.nplanuse;
+        ParallelDescriptor::ReduceLongSum(n);
+        return n;
+    }
+};
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int nrep = 3;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nrep", nrep);
+        }
+
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        const Periodicity period(IntVect(AMREX_D_DECL(n_cell,n_cell,n_cell)));
+
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        // A second layout that overlaps the first one in many ways
+        BoxArray ba2(domain);
+        ba2.maxSize(max_grid_size*3/2);
+        Vector<int> pmap2(ba2.size());
+        for (int i = 0; i < ba2.size(); ++i) {
+            pmap2[i] = (i*7+1) % ParallelDescriptor::NProcs();
+        }
+        DistributionMapping dm2(pmap2);
+
+        bool ok = true;
+        int step = 0;
+
+        // Each operation with flag off and on, nrep times on new data
+        auto compare = [&] (const std::string& name, bool& flag, MultiFab& mf,
+                            const std::function<void(MultiFab&)>& f, int nrep)
+        {
+            const bool flag0 = flag;
+            MultiFab mf2(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrowVect());
+            long n = 0;
+            for (step = 0; step < nrep; ++step) {
+                fill(mf, step);
+                fill(mf2, step);
+                flag = false;
+                f(mf);
+                flag = true;
+                f(mf2);
+                flag = flag0;
+                n += ndiff(mf, mf2);
+            }
+            ok = report(name, n) && ok;
+        };
+
+        // The messages unpacked in order and as received
+        auto& as_received = FabArrayBase::UnpackAsReceived;
+
+        {
+            MultiFab mf(ba, dm, 2, 2);
+            compare("periodic FillBoundary", as_received, mf,
+                    [&] (MultiFab& x) { x.FillBoundary(period); }, 1);
+        }
+        {
+            MultiFab mf(amrex::convert(ba,IntVect(1)), dm, 2, 1);
+            compare("nodal periodic FillBoundary", as_received, mf,
+                    [&] (MultiFab& x) { x.FillBoundary(period); }, 1);
+        }
+        {
+            MultiFab src(ba2, dm2, 2, 0);
+            fill(src);
+            MultiFab mf(ba, dm, 2, 2);
+            compare("periodic ParallelCopy", as_received, mf,
+                    [&] (MultiFab& x) { x.ParallelCopy(src, 0, 0, 2, 0, 2, period); }, 1);
+        }
+        {
+            // overlapping grown source boxes write the same cells
+            MultiFab src(ba2, dm2, 2, 2);
+            fill(src);
+            MultiFab mf(ba, dm, 2, 1);
+            compare("periodic ParallelCopy of ghost cells", as_received, mf,
+                    [&] (MultiFab& x) { x.ParallelCopy(src, 0, 0, 2, 2, 1, period); }, 1);
+        }
+        {
+            // overlapping grown source boxes add up in the same cells
+            MultiFab src(ba2, dm2, 2, 3);
+            fill(src);
+            MultiFab mf(ba, dm, 2, 1);
+            compare("periodic ParallelAdd", as_received, mf,
+                    [&] (MultiFab& x) { x.ParallelAdd(src, 0, 0, 2, 3, 1, period); }, 1);
+        }
+        {
+            MultiFab src(amrex::convert(ba2,IntVect(1)), dm2, 1, 1);
+            fill(src);
+            MultiFab mf(amrex::convert(ba,IntVect(1)), dm, 1, 0);
+            compare("nodal ParallelAdd", as_received, mf,
+                    [&] (MultiFab& x) { x.ParallelAdd(src, 0, 0, 1, 1, 0, period); }, 1);
+        }
+
+        // Persistent requests and buffers, reused by the later steps,
+        // with more components than are sent at a time and with two
+        // plans for one FB and CPC
+        auto& persistent = FabArrayBase::PersistentComm;
+        if (persistent) {
+            const long nplanuse = PlanStats::nplanuse();
+            const int ncomp = FabArrayBase::MaxComp + 1;
+            {
+                MultiFab mf(ba, dm, ncomp, 2);
+                compare("persistent periodic FillBoundary", persistent, mf,
+                        [&] (MultiFab& x) { x.FillBoundary(period); }, nrep);
+                compare("persistent FillBoundary of one component", persistent, mf,
+                        [&] (MultiFab& x) { x.FillBoundary(1, 1, period); }, nrep);
+            }
+            {
+                MultiFab src(ba2, dm2, ncomp, 1);
+                MultiFab mf(ba, dm, ncomp, 2);
+                compare("persistent periodic ParallelCopy", persistent, mf,
+                        [&] (MultiFab& x) {
+                            fill(src, step);
+                            x.ParallelCopy(src, 0, 0, ncomp, 0, 2, period);
+                        }, nrep);
+                compare("persistent periodic ParallelCopy of ghost cells", persistent, mf,
+                        [&] (MultiFab& x) {
+                            fill(src, step);
+                            x.ParallelCopy(src, 0, 0, ncomp, 1, 1, period);
+                        }, nrep);
+            }
+            if (ParallelDescriptor::NProcs() > 1 && PlanStats::nplanuse() == nplanuse) {
+                amrex::Print() << "  persistent CommPlans were not used\n";
+                ok = false;
+            }
+        } else {
+            amrex::Print() << "  fabarray.persistent_comm = 0, persistent requests not tested\n";
+        }
+
+        // The fused FillBoundary of FabArrays that differ in layout, index
+        // type, number of components and ghost cells, one of them without
+        // ghost cells, against FillBoundary of each
+        {
+            if (ParallelDescriptor::NProcs() == 1) {
+                amrex::Print() << "  with one process the fused FillBoundary falls back to"
+                               << " FillBoundary\n";
+            }
+
+            Vector<MultiFab> mfs;
+            mfs.emplace_back(ba, dm, 3, 2);
+            mfs.emplace_back(amrex::convert(ba,IntVect(1)), dm, 1, 1);
+            mfs.emplace_back(amrex::convert(ba2,IntVect::TheDimensionVector(0)), dm2, 2,
+                             IntVect(AMREX_D_DECL(1,2,3)));
+            mfs.emplace_back(ba2, dm2, 1, 0);
+            mfs.emplace_back(amrex::convert(ba,IntVect::TheDimensionVector(AMREX_SPACEDIM-1)),
+                             dm, 1, 4);
+
+            Vector<MultiFab> sep;
+            Vector<FabArray<FArrayBox>*> fused;
+            for (auto& mf : mfs) {
+                fill(mf);
+                sep.emplace_back(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrowVect());
+                MultiFab::Copy(sep.back(), mf, 0, 0, mf.nComp(), mf.nGrowVect());
+                fused.push_back(&mf);
+            }
+
+            for (auto& mf : sep) {
+                mf.FillBoundary(period);
+            }
+            amrex::FillBoundary(fused, period);
+
+            for (int i = 0; i < static_cast<int>(mfs.size()); ++i) {
+                ok = report("fused FillBoundary, FabArray " + std::to_string(i),
+                            ndiff(mfs[i], sep[i])) && ok;
+            }
+        }
+
+        if (!ok) amrex::Abort("Unpacking as received, persistent requests or the fused"
+                              " FillBoundary change the results");
+        amrex::Print() << "  unpacking as received, persistent requests and the fused"
+                       << " FillBoundary give the same results\n";
+    }
+    amrex::Finalize();
+}
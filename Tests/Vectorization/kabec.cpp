@@ -0,0 +1,50 @@
+#include <kdecl.H>
+#include <AMReX_MLABecLap_K.H>
+
+using namespace amrex;
+
+void abec_gsrb_c (Box const& bx, FArrayBox& phifab, FArrayBox const& rhsfab,
+                  FArrayBox const& afab, FArrayBox const& bxfab,
+                  FArrayBox const& byfab, FArrayBox const& bzfab,
+                  BaseFab<int> const& mfab, FArrayBox const& ffab, int redblack)
+{
+    const auto m = mfab.const_array();
+    const auto f = ffab.const_array();
+    abec_gsrb(bx, phifab.array(), rhsfab.const_array(), 0.5, afab.const_array(),
+              1.0, 1.0, 1.0, bxfab.const_array(), byfab.const_array(), bzfab.const_array(),
+              m, m, m, m, m, m, f, f, f, f, f, f, bx, redblack, phifab.nComp());
+}
+
+void abec_gsrb_c_simd (Box const& bx, FArrayBox& phifab, FArrayBox const& rhsfab,
+                       FArrayBox const& afab, FArrayBox const& bxfab,
+                       FArrayBox const& byfab, FArrayBox const& bzfab,
+                       BaseFab<int> const& mfab, FArrayBox const& ffab, int redblack)
+{
+    const auto m = mfab.const_array();
+    const auto f = ffab.const_array();
+    abec_gsrb_simd(bx, phifab.array(), rhsfab.const_array(), 0.5, afab.const_array(),
+                   1.0, 1.0, 1.0, bxfab.const_array(), byfab.const_array(), bzfab.const_array(),
+                   m, m, m, m, m, m, f, f, f, f, f, f, bx, redblack, phifab.nComp());
+}
+
+void abec_adotx_c (Box const& bx, FArrayBox& yfab, FArrayBox const& xfab,
+                   FArrayBox const& afab, FArrayBox const& bxfab,
+                   FArrayBox const& byfab, FArrayBox const& bzfab,
+                   Array<Real,AMREX_SPACEDIM> const& dxinv)
+{
+    mlabeclap_adotx(bx, yfab.array(), xfab.const_array(), afab.const_array(),
+                    bxfab.const_array(), byfab.const_array(), bzfab.const_array(),
+                    GpuArray<Real,AMREX_SPACEDIM>{dxinv[0],dxinv[1],dxinv[2]},
+                    0.5, 1.0, yfab.nComp());
+}
+
+void abec_adotx_c_simd (Box const& bx, FArrayBox& yfab, FArrayBox const& xfab,
+                        FArrayBox const& afab, FArrayBox const& bxfab,
+                        FArrayBox const& byfab, FArrayBox const& bzfab,
+                        Array<Real,AMREX_SPACEDIM> const& dxinv)
+{
+    mlabeclap_adotx_simd(bx, yfab.array(), xfab.const_array(), afab.const_array(),
+                         bxfab.const_array(), byfab.const_array(), bzfab.const_array(),
+                         GpuArray<Real,AMREX_SPACEDIM>{dxinv[0],dxinv[1],dxinv[2]},
+                         0.5, 1.0, yfab.nComp());
+}
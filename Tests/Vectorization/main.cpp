@@ -1,4 +1,6 @@
 
+#include <cmath>
+
 #include <AMReX.H>
 #include <AMReX_Print.H>
 
@@ -6,6 +8,37 @@
 
 using namespace amrex;
 
+namespace {
+
+// Values that vary from cell to cell, in [lo,hi]
+void fillVarying (FArrayBox& fab, Real lo, Real hi)
+{
+    const Box& b = fab.box();
+    const auto a = fab.array();
+    const auto blo = amrex::lbound(b);
+    const auto bhi = amrex::ubound(b);
+    for (int n = 0; n < fab.nComp(); ++n) {
+        for         (int k = blo.z; k <= bhi.z; ++k) {
+            for     (int j = blo.y; j <= bhi.y; ++j) {
+                for (int i = blo.x; i <= bhi.x; ++i) {
+                    a(i,j,k,n) = lo + (hi-lo)*0.5*(1.0+std::sin(0.7*i + 1.3*j + 2.9*k + n));
+                }
+            }
+        }
+    }
+}
+
+// Largest difference between a and b relative to the largest |a|
+Real relDiff (FArrayBox const& a, FArrayBox const& b, Box const& bx)
+{
+    FArrayBox d(bx, a.nComp());
+    d.copy(a, bx);
+    d.minus(b, bx, 0, 0, a.nComp());
+    return d.norm(bx, 0, 0, a.nComp()) / std::max(a.norm(bx, 0, 0, a.nComp()), Real(1.e-300));
+}
+
+}
+
 int main(int argc, char* argv[])
 {
     amrex::Initialize(argc,argv);
@@ -106,6 +139,115 @@ int main(int argc, char* argv[])
                            << "              C++ w/ simd time: " << t2-t1  << "\n"
                            << "              C++ w/o simd time: " << t3-t2 << std::endl;
         }
+
+        // ABecLaplacian: scalar loops vs. ParallelForSIMD
+        {
+            const int nc = 1;
+            FArrayBox phifab(bxg2,nc), rhsfab(bx,nc), afab(bx,1), yfab(bx,nc);
+            FArrayBox bxfab(amrex::convert(bx,IntVect::TheDimensionVector(0)),nc);
+            FArrayBox byfab(amrex::convert(bx,IntVect::TheDimensionVector(1)),nc);
+            FArrayBox bzfab(amrex::convert(bx,IntVect::TheDimensionVector(2)),nc);
+            BaseFab<int> mfab(bxg2,1);
+            FArrayBox ffab(bxg2,nc);
+
+            phifab.setVal(1.0);
+            rhsfab.setVal(0.5);
+            afab.setVal(1.0);
+            bxfab.setVal(1.0);
+            byfab.setVal(1.0);
+            bzfab.setVal(1.0);
+            mfab.setVal(1);
+            ffab.setVal(0.1);
+
+            const int ntimes = 1000;
+
+            double t0 = amrex::second();
+
+            for (int i = 0; i < ntimes; ++i) {
+                __asm__ __volatile__("" : : : "memory");
+                abec_gsrb_c(bx, phifab, rhsfab, afab, bxfab, byfab, bzfab, mfab, ffab, i%2);
+            }
+
+            double t1 = amrex::second();
+
+            for (int i = 0; i < ntimes; ++i) {
+                __asm__ __volatile__("" : : : "memory");
+                abec_gsrb_c_simd(bx, phifab, rhsfab, afab, bxfab, byfab, bzfab, mfab, ffab, i%2);
+            }
+
+            double t2 = amrex::second();
+
+            for (int i = 0; i < ntimes; ++i) {
+                __asm__ __volatile__("" : : : "memory");
+                abec_adotx_c(bx, yfab, phifab, afab, bxfab, byfab, bzfab, dxinv);
+            }
+
+            double t3 = amrex::second();
+
+            for (int i = 0; i < ntimes; ++i) {
+                __asm__ __volatile__("" : : : "memory");
+                abec_adotx_c_simd(bx, yfab, phifab, afab, bxfab, byfab, bzfab, dxinv);
+            }
+
+            double t4 = amrex::second();
+
+            const double mcells = double(bx.numPts())*nc*ntimes*1.e-6;
+            amrex::Print() << "abec_gsrb: scalar time: " << t1-t0 << " (" << mcells/(t1-t0) << " Mcells/s)\n"
+                           << "           SIMD time: " << t2-t1 << " (" << mcells/(t2-t1) << " Mcells/s)\n"
+                           << "abec_adotx: scalar time: " << t3-t2 << " (" << mcells/(t3-t2) << " Mcells/s)\n"
+                           << "            SIMD time: " << t4-t3 << " (" << mcells/(t4-t3) << " Mcells/s)"
+                           << std::endl;
+        }
+
+        // ABecLaplacian: the scalar and the SIMD kernels give the same phi and
+        // y, on a box with negative indices and rows that are not a multiple
+        // of the SIMD width
+        {
+            const Box cbx(IntVect(-5), IntVect(27));
+            const Box& cbxg = amrex::grow(cbx,1);
+            FArrayBox phis(cbxg), phiv(cbxg), rhsfab(cbx), afab(cbx), ys(cbx), yv(cbx);
+            FArrayBox bxfab(amrex::convert(cbx,IntVect::TheDimensionVector(0)));
+            FArrayBox byfab(amrex::convert(cbx,IntVect::TheDimensionVector(1)));
+            FArrayBox bzfab(amrex::convert(cbx,IntVect::TheDimensionVector(2)));
+            BaseFab<int> mfab(cbxg,1);
+            FArrayBox ffab(cbxg);
+
+            fillVarying(phis, -1.0, 1.0);
+            phiv.copy(phis);
+            fillVarying(rhsfab, -0.5, 0.5);
+            fillVarying(afab, 0.5, 1.5);
+            fillVarying(bxfab, 1.0, 2.0);
+            fillVarying(byfab, 0.5, 1.0);
+            fillVarying(bzfab, 1.0, 3.0);
+            fillVarying(ffab, 0.0, 0.2);
+            {
+                const auto m = mfab.array();
+                const auto lo = amrex::lbound(cbxg);
+                const auto hi = amrex::ubound(cbxg);
+                for         (int k = lo.z; k <= hi.z; ++k) {
+                    for     (int j = lo.y; j <= hi.y; ++j) {
+                        for (int i = lo.x; i <= hi.x; ++i) {
+                            m(i,j,k) = (i+2*j+3*k) % 3 == 0;
+                        }
+                    }
+                }
+            }
+
+            for (int sweep = 0; sweep < 4; ++sweep) {
+                abec_gsrb_c(cbx, phis, rhsfab, afab, bxfab, byfab, bzfab, mfab, ffab, sweep%2);
+                abec_gsrb_c_simd(cbx, phiv, rhsfab, afab, bxfab, byfab, bzfab, mfab, ffab, sweep%2);
+            }
+            abec_adotx_c(cbx, ys, phis, afab, bxfab, byfab, bzfab, dxinv);
+            abec_adotx_c_simd(cbx, yv, phis, afab, bxfab, byfab, bzfab, dxinv);
+
+            const Real dphi = relDiff(phis, phiv, cbxg);
+            const Real dy = relDiff(ys, yv, cbx);
+            amrex::Print() << "abec_gsrb: scalar and SIMD phi differ by " << dphi << "\n"
+                           << "abec_adotx: scalar and SIMD y differ by " << dy << std::endl;
+            if (!(dphi < 1.e-13) || !(dy < 1.e-13)) {
+                amrex::Abort("The scalar and SIMD ABecLaplacian kernels do not agree");
+            }
+        }
     }
     amrex::Finalize();
 }
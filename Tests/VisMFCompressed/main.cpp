@@ -0,0 +1,143 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+
+using namespace amrex;
+
+namespace {
+
+// Smooth data of different magnitudes in each component, with a NaN in
+// the last component of the first FAB, which quantize cannot store.
+void fill (MultiFab& mf)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.fabbox();
+        auto const a = mf.array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for (int n = 0; n < mf.nComp(); ++n) {
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        a(i,j,k,n) = std::sin(0.1*i + 0.2*j + 0.3*k + n) * std::pow(10.0, 3*n-3);
+                    }
+                }
+            }
+        }
+        if (mfi.index() == 0) {
+            a(lo.x,lo.y,lo.z,mf.nComp()-1) = std::numeric_limits<Real>::quiet_NaN();
+        }
+    }
+}
+
+// Whether b, read back, matches a on bx and components [scomp,scomp+ncomp),
+// bitwise or, if tol > 0, within tol.  NaN must be read back as NaN.
+bool same (const FArrayBox& a, const FArrayBox& b, const Box& bx, int scomp, int dcomp,
+           int ncomp, Real tol)
+{
+    auto const aa = a.const_array();
+    auto const ba = b.const_array();
+    const auto lo = amrex::lbound(bx);
+    const auto hi = amrex::ubound(bx);
+    bool ok = true;
+    for (int n = 0; n < ncomp; ++n) {
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    const Real x = aa(i,j,k,scomp+n);
+                    const Real y = ba(i,j,k,dcomp+n);
+                    if (tol > 0.0 && !std::isnan(x)) {
+                        ok = ok && std::abs(x-y) <= tol + 1.e-14*std::abs(x);
+                    } else {
+                        ok = ok && std::memcmp(&x, &y, sizeof(Real)) == 0;
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+bool check (const std::string& name, bool ok)
+{
+    ParallelDescriptor::ReduceBoolAnd(ok);
+    amrex::Print() << "  " << name << (ok ? ": ok\n" : ": FAILED\n");
+    return ok;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        int ncomp = 3;
+        int nghost = 1;
+        Real tolerance = 1.e-6;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ncomp", ncomp);
+            pp.query("nghost", nghost);
+            pp.query("tolerance", tolerance);
+        }
+
+        BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+        MultiFab mf(ba, dm, ncomp, nghost);
+        fill(mf);
+
+        VisMF::SetHeaderVersion(VisMF::Header::Compressed_v1);
+        bool ok = true;
+
+        for (const std::string compressor : {"shuffle_lz", "quantize"})
+        {
+            const Real tol = (compressor == "quantize") ? tolerance : 0.0;
+            VisMF::SetCompressor(compressor);
+            VisMF::SetCompressionTolerance(tol);
+
+            const std::string name = "mf_" + compressor;
+            VisMF::Write(mf, name);
+            ParallelDescriptor::Barrier();
+
+            // The whole MultiFab, ghost cells included
+            MultiFab mfr;
+            VisMF::Read(mfr, name);
+            bool okr = mfr.boxArray() == ba && mfr.nComp() == ncomp && mfr.nGrow() == nghost;
+            if (okr) {
+                MultiFab tmp(ba, dm, ncomp, nghost);
+                tmp.ParallelCopy(mfr, 0, 0, ncomp, nghost, nghost);
+                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                    okr = same(mf[mfi], tmp[mfi], mfi.fabbox(), 0, 0, ncomp, tol) && okr;
+                }
+            }
+            ok = check(compressor + " VisMF::Read", okr) && ok;
+
+            // Each component of the FABs by itself
+            VisMF vmf(name);
+            bool okc = true;
+            for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                for (int n = 0; n < ncomp; ++n) {
+                    std::unique_ptr<FArrayBox> fab(vmf.readFAB(mfi.index(), n));
+                    okc = fab->box() == mfi.fabbox() && fab->nComp() == 1 &&
+                        same(mf[mfi], *fab, mfi.fabbox(), n, 0, 1, tol) && okc;
+                }
+            }
+            ok = check(compressor + " readFAB", okc) && ok;
+        }
+
+        if (!ok) amrex::Abort("Compressed_v1 does not read back what it wrote");
+    }
+    amrex::Finalize();
+}
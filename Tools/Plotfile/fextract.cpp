@@ -1,7 +1,6 @@
 #include <AMReX.H>
 #include <AMReX_Print.H>
 #include <AMReX_PlotFileUtil.H>
-#include <AMReX_MultiFabUtil.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <limits>
 #include <iterator>
@@ -162,6 +161,12 @@ void main_main()
     Vector<Real> pos;
     Vector<Vector<Real> > data(var_names.size());
 
+    // Only the grids the slice passes through are read.  When all the
+    // variables are extracted, the components of a grid are read together.
+    if (var_names == var_names_pf) {
+        pf.setReadAhead(var_names.size()-1);
+    }
+
     IntVect rr{1};
     for (int ilev = coarse_level; ilev <= fine_level; ++ilev) {
         Box slice_box(ivloc*rr,ivloc*rr);
@@ -170,116 +175,44 @@ void main_main()
 
         Array<Real,AMREX_SPACEDIM> dx = pf.cellSize(ilev);
 
+        // cells covered by the next finer level are skipped
+        BoxArray fine_ba;
         if (ilev < fine_level) {
             IntVect ratio{pf.refRatio(ilev)};
             for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
                 ratio[idim] = 1;
             }
-            const iMultiFab mask = makeFineMask(pf.boxArray(ilev), pf.DistributionMap(ilev),
-                                                pf.boxArray(ilev+1), ratio);
-            for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                    const Box& bx = mfi.validbox() & slice_box;
-                    if (bx.ok()) {
-                        const auto& m = mask.array(mfi);
-                        const auto& fab = mf.array(mfi);
-                        const auto lo = amrex::lbound(bx);
-                        const auto hi = amrex::ubound(bx);
-                        for         (int k = lo.z; k <= hi.z; ++k) {
-                            for     (int j = lo.y; j <= hi.y; ++j) {
-                                for (int i = lo.x; i <= hi.x; ++i) {
-                                    if (m(i,j,k) == 0) { // not covered by fine
-                                        if (pos.size() == data[ivar].size()) {
-                                            Array<Real,AMREX_SPACEDIM> p
-                                                = {AMREX_D_DECL(problo[0]+(i+0.5)*dx[0],
-                                                                problo[1]+(j+0.5)*dx[1],
-                                                                problo[2]+(k+0.5)*dx[2])};
-                                            pos.push_back(p[idir]);
-                                        }
-                                        data[ivar].push_back(fab(i,j,k));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            fine_ba = amrex::coarsen(pf.boxArray(ilev+1), ratio);
             rr *= ratio;
-        } else {
-            for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                    const Box& bx = mfi.validbox() & slice_box;
-                    if (bx.ok()) {
-                        const auto& fab = mf.array(mfi);
-                        const auto lo = amrex::lbound(bx);
-                        const auto hi = amrex::ubound(bx);
-                        for         (int k = lo.z; k <= hi.z; ++k) {
-                            for     (int j = lo.y; j <= hi.y; ++j) {
-                                for (int i = lo.x; i <= hi.x; ++i) {
-                                    if (pos.size() == data[ivar].size()) {
-                                        Array<Real,AMREX_SPACEDIM> p
-                                            = {AMREX_D_DECL(problo[0]+(i+0.5)*dx[0],
-                                                            problo[1]+(j+0.5)*dx[1],
-                                                            problo[2]+(k+0.5)*dx[2])};
-                                        pos.push_back(p[idir]);
-                                    }
-                                    data[ivar].push_back(fab(i,j,k));
-                                }
-                            }
-                        }
-                    }
-                }
-            }
         }
-    }
 
-#ifdef BL_USE_MPI
-    {
-        const int numpts = pos.size();
-        auto numpts_vec = ParallelDescriptor::Gather(numpts,
-                                                     ParallelDescriptor::IOProcessorNumber());
-        Vector<int> recvcnt, disp;
-        Vector<Real> allpos;
-        Vector<Vector<Real> > alldata(data.size());
-        if (ParallelDescriptor::IOProcessor()) {
-            recvcnt.resize(numpts_vec.size());
-            disp.resize(numpts_vec.size());
-            int ntot = 0;
-            disp[0] = 0;
-            for (int i = 0; i < numpts_vec.size(); ++i) {
-                ntot += numpts_vec[i];
-                recvcnt[i] = numpts_vec[i];
-                if (i+1 < numpts_vec.size()) {
-                    disp[i+1] = disp[i] + numpts_vec[i];
+        Vector<FArrayBox> fabs;
+        for (int ivar = 0; ivar < var_names.size(); ++ivar) {
+            fabs.emplace_back(pf.get(ilev, var_names[ivar], slice_box));
+        }
+
+        for (auto const& is : pf.boxArray(ilev).intersections(slice_box)) {
+            const Box& bx = is.second;
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            for         (int k = lo.z; k <= hi.z; ++k) {
+                for     (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        const IntVect iv{AMREX_D_DECL(i,j,k)};
+                        if (!fine_ba.empty() and fine_ba.contains(iv)) continue;
+                        Array<Real,AMREX_SPACEDIM> p
+                            = {AMREX_D_DECL(problo[0]+(i+0.5)*dx[0],
+                                            problo[1]+(j+0.5)*dx[1],
+                                            problo[2]+(k+0.5)*dx[2])};
+                        pos.push_back(p[idir]);
+                        for (int ivar = 0; ivar < var_names.size(); ++ivar) {
+                            data[ivar].push_back(fabs[ivar](iv));
+                        }
+                    }
                 }
             }
-            allpos.resize(ntot);
-            alldata.resize(data.size());
-            for (auto& v : alldata) {
-                v.resize(ntot);
-            }
-        } else {
-            recvcnt.resize(1);
-            disp.resize(1);
-            allpos.resize(1);
-            for (auto& v: alldata) {
-                v.resize(1);
-            }
-        }
-        ParallelDescriptor::Gatherv(pos.data(), numpts, allpos.data(), recvcnt, disp,
-                                    ParallelDescriptor::IOProcessorNumber());
-        for (int i = 0; i < data.size(); ++i) {
-            ParallelDescriptor::Gatherv(data[i].data(), numpts, alldata[i].data(), recvcnt, disp,
-                                        ParallelDescriptor::IOProcessorNumber());
-        }
-        if (ParallelDescriptor::IOProcessor()) {
-            pos = std::move(allpos);
-            data = std::move(alldata);
         }
     }
-#endif
 
     if (ParallelDescriptor::IOProcessor()) {
         Vector<std::pair<Real,int> > posidx;